@@ -0,0 +1,198 @@
+/*  AutoSaver.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AutoSaver.h"
+
+#include "LabelModel.h"
+#include "Settings.h"
+#include "XmlLabelCreator.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <QtDebug>
+
+
+namespace glabels
+{
+
+	///
+	/// Constructor
+	///
+	AutoSaver::AutoSaver( LabelModel* model )
+		: mModel(model), mChangeSerial(0), mSavingChangeSerial(0), mSavedChangeSerial(0)
+	{
+		connect( &mTimer, SIGNAL(timeout()), this, SLOT(onTimeout()) );
+		connect( &mSaveWatcher, SIGNAL(finished()), this, SLOT(onSaveFinished()) );
+		connect( mModel, SIGNAL(changed()), this, SLOT(onModelChanged()) );
+		connect( Settings::instance(), SIGNAL(changed()), this, SLOT(onSettingsChanged()) );
+
+		onSettingsChanged();
+	}
+
+
+	///
+	/// Destructor
+	///
+	AutoSaver::~AutoSaver()
+	{
+		mSaveWatcher.waitForFinished();
+	}
+
+
+	///
+	/// Wait for a save in progress, e.g. before saving explicitly
+	///
+	void AutoSaver::waitForFinished()
+	{
+		mSaveWatcher.waitForFinished();
+	}
+
+
+	///
+	/// Remove backup file, e.g. after an explicit save or when closed cleanly
+	///
+	void AutoSaver::discard()
+	{
+		mSaveWatcher.waitForFinished();
+
+		if ( !mSavedFileName.isEmpty() )
+		{
+			QFile::remove( autoSavePath( mSavedFileName ) );
+			mSavedFileName.clear();
+		}
+
+		// Also one recovered from an earlier session
+		if ( !mModel->fileName().isEmpty() )
+		{
+			QFile::remove( autoSavePath( mModel->fileName() ) );
+		}
+	}
+
+
+	///
+	/// Backup file of label file
+	///
+	QString AutoSaver::autoSavePath( const QString& fileName )
+	{
+		return fileName + ".autosave";
+	}
+
+
+	///
+	/// Is there a backup of label file that is newer than the file itself?
+	///
+	bool AutoSaver::hasNewerAutoSave( const QString& fileName )
+	{
+		QFileInfo autoSaveInfo( autoSavePath( fileName ) );
+		if ( !autoSaveInfo.isFile() )
+		{
+			return false;
+		}
+
+		return autoSaveInfo.lastModified() > QFileInfo( fileName ).lastModified();
+	}
+
+
+	///
+	/// Settings changed handler
+	///
+	void AutoSaver::onSettingsChanged()
+	{
+		int minutes = Settings::autoSaveInterval();
+		if ( minutes > 0 )
+		{
+			if ( !mTimer.isActive() || (mTimer.interval() != minutes*60*1000) )
+			{
+				mTimer.start( minutes*60*1000 );
+			}
+		}
+		else
+		{
+			mTimer.stop();
+		}
+	}
+
+
+	///
+	/// Model changed handler
+	///
+	void AutoSaver::onModelChanged()
+	{
+		mChangeSerial++;
+	}
+
+
+	///
+	/// Timer handler
+	///
+	void AutoSaver::onTimeout()
+	{
+		// Untitled labels are covered by the edit journal alone
+		if ( !mModel->isModified() || mModel->fileName().isEmpty() || mSaveWatcher.isRunning() )
+		{
+			return;
+		}
+
+		// Backup is still current
+		if ( (mChangeSerial == mSavedChangeSerial) && (mModel->fileName() == mSavedFileName) )
+		{
+			return;
+		}
+
+		// Label was saved as another file since the last backup
+		if ( !mSavedFileName.isEmpty() && (mModel->fileName() != mSavedFileName) )
+		{
+			QFile::remove( autoSavePath( mSavedFileName ) );
+		}
+
+		mSavingChangeSerial = mChangeSerial;
+		mSavedFileName      = mModel->fileName();
+
+		QSharedPointer<LabelModel> snapshot( mModel->save(), &QObject::deleteLater );
+
+		mSaveWatcher.setFuture( QtConcurrent::run( &AutoSaver::writeSnapshot, snapshot, autoSavePath( mSavedFileName ) ) );
+	}
+
+
+	///
+	/// Save finished handler
+	///
+	void AutoSaver::onSaveFinished()
+	{
+		if ( !mSaveWatcher.result() )
+		{
+			qWarning() << "Auto save of" << mSavedFileName << "failed.";
+			return;
+		}
+
+		mSavedChangeSerial = mSavingChangeSerial;
+	}
+
+
+	///
+	/// Serialize, compress and atomically write snapshot (runs in worker thread)
+	///
+	bool AutoSaver::writeSnapshot( QSharedPointer<LabelModel> snapshot, QString fileName )
+	{
+		return XmlLabelCreator::writeFile( snapshot.data(), fileName );
+	}
+
+} // namespace glabels
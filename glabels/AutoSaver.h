@@ -0,0 +1,110 @@
+/*  AutoSaver.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AutoSaver_h
+#define AutoSaver_h
+
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QTimer>
+
+
+namespace glabels
+{
+
+	// Forward references
+	class LabelModel;
+
+
+	///
+	/// Auto Saver
+	///
+	/// Periodically saves a modified label to a backup file next to it
+	/// ("<name>.autosave"), leaving the label's own file, its modified state and
+	/// its edit journal alone.  The backup is removed once the label is saved
+	/// explicitly or closed cleanly, and offered for recovery when the label is
+	/// opened again.  The GUI thread only takes a snapshot (a clone of the model,
+	/// whose objects share image data with the originals); serializing,
+	/// compressing and writing the snapshot happens on a worker thread.
+	///
+	class AutoSaver : public QObject
+	{
+		Q_OBJECT
+
+
+		/////////////////////////////////
+		// Life Cycle
+		/////////////////////////////////
+	public:
+		AutoSaver( LabelModel* model );
+		~AutoSaver() override;
+
+
+		/////////////////////////////////
+		// Public methods
+		/////////////////////////////////
+	public:
+		void waitForFinished();
+		void discard();
+
+		static QString autoSavePath( const QString& fileName );
+		static bool hasNewerAutoSave( const QString& fileName );
+
+
+		/////////////////////////////////
+		// Private slots
+		/////////////////////////////////
+	private slots:
+		void onSettingsChanged();
+		void onModelChanged();
+		void onTimeout();
+		void onSaveFinished();
+
+
+		/////////////////////////////////
+		// Private methods
+		/////////////////////////////////
+	private:
+		static bool writeSnapshot( QSharedPointer<LabelModel> snapshot, QString fileName );
+
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		LabelModel*           mModel;
+
+		QTimer                mTimer;
+		quint64               mChangeSerial;
+		quint64               mSavingChangeSerial;
+		quint64               mSavedChangeSerial;
+		QString               mSavedFileName;
+
+		QFutureWatcher<bool>  mSaveWatcher;
+
+	};
+
+}
+
+
+#endif // AutoSaver_h
@@ -41,7 +41,13 @@ namespace glabels
 				TextNode filenameNode = imageObject->filenameNode();
 				if ( !filenameNode.isField()  )
 				{
-					if ( const QImage* image = imageObject->image() )
+					// Prefer the original encoded data; avoids decoding (and re-encoding) it
+					QByteArray imageData = imageObject->imageData();
+					if ( !imageData.isEmpty() )
+					{
+						addImageData( filenameNode.data(), imageData );
+					}
+					else if ( const QImage* image = imageObject->image() )
 					{
 						addImage( filenameNode.data(), *imageObject->image() );
 					}
@@ -61,25 +67,48 @@ namespace glabels
 
 	bool DataCache::hasImage( const QString& name ) const
 	{
-		return mImageMap.contains( name );
+		return mImageMap.contains( name ) || mImageDataMap.contains( name );
 	}
 
 
 	QImage DataCache::getImage( const QString& name ) const
 	{
+		auto it = mImageDataMap.constFind( name );
+		if ( it != mImageDataMap.constEnd() )
+		{
+			return QImage::fromData( it.value() );
+		}
+
 		return mImageMap[ name ];
 	}
 
 
 	void DataCache::addImage( const QString& name, const QImage& image )
 	{
+		mImageDataMap.remove( name );
 		mImageMap[ name ] = image;
 	}
 
 
+	///
+	/// Get encoded (PNG) image data.  Empty if image was only added in decoded form.
+	///
+	QByteArray DataCache::getImageData( const QString& name ) const
+	{
+		return mImageDataMap.value( name );
+	}
+
+
+	void DataCache::addImageData( const QString& name, const QByteArray& data )
+	{
+		mImageMap.remove( name );
+		mImageDataMap[ name ] = data;
+	}
+
+
 	QList<QString> DataCache::imageNames() const
 	{
-		return mImageMap.keys();
+		return mImageMap.keys() + mImageDataMap.keys();
 	}
 
 	
@@ -24,6 +24,8 @@
 
 #include "LabelModel.h"
 
+#include <QImage>
+
 
 namespace glabels
 {
@@ -38,6 +40,8 @@ namespace glabels
 		bool hasImage( const QString& name ) const;
 		QImage getImage( const QString& name ) const;
 		void addImage( const QString& name, const QImage& image );
+		QByteArray getImageData( const QString& name ) const;
+		void addImageData( const QString& name, const QByteArray& data );
 		QList<QString> imageNames() const;
 
 		bool hasSvg( const QString& name ) const;
@@ -48,6 +52,7 @@ namespace glabels
 		
 	private:
 		QMap<QString,QImage> mImageMap;
+		QMap<QString,QByteArray> mImageDataMap;
 		QMap<QString,QByteArray> mSvgMap;
 
 	};
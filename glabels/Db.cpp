@@ -21,13 +21,23 @@
 #include "Db.h"
 
 #include "Config.h"
+#include "Constants.h"
+#include "DbCache.h"
 #include "StrUtil.h"
 #include "FileUtil.h"
+#include "LabelModel.h"
 #include "XmlCategoryParser.h"
 #include "XmlPaperParser.h"
 #include "XmlTemplateParser.h"
+#include "XmlTemplateCreator.h"
 #include "XmlVendorParser.h"
 
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QSet>
+#include <QtConcurrent>
+#include <QtMath>
 #include <QtDebug>
 #include <QtGlobal>
 
@@ -46,6 +56,36 @@ namespace glabels
 		{
 			return StrUtil::comparePartNames( a->name(), b->name() ) < 0;
 		}
+
+		//
+		// Similar templates (see Template::isSimilarTo) have identical page
+		// sizes and frames of the same size within EPSILON.  Frame sizes are
+		// quantized to 2*EPSILON (the largest difference in width or height
+		// between similar frames, e.g. round frames whose radii differ by
+		// EPSILON), so similar templates are always in the same or an
+		// adjacent bucket.
+		//
+		QString geometryKey( const Template *tmplate, int wOffset = 0, int hOffset = 0 )
+		{
+			const Frame *frame = tmplate->frames().first();
+
+			qint64 wBucket = qFloor( frame->w().pt() / (2*EPSILON.pt()) ) + wOffset;
+			qint64 hBucket = qFloor( frame->h().pt() / (2*EPSILON.pt()) ) + hOffset;
+
+			return QString( "%1|%2|%3|%4|%5" )
+				.arg( tmplate->paperId() )
+				.arg( tmplate->pageWidth().pt(), 0, 'g', 17 )
+				.arg( tmplate->pageHeight().pt(), 0, 'g', 17 )
+				.arg( wBucket )
+				.arg( hBucket );
+		}
+
+		XmlTemplateParser::ParsedFile parseTemplateFile( const QString& filePath )
+		{
+			XmlTemplateParser::ParsedFile parsed;
+			XmlTemplateParser().parseFile( filePath, parsed );
+			return parsed;
+		}
 	}
 
 
@@ -55,12 +95,24 @@ namespace glabels
 	QList<Paper*>    Db::mPapers;
 	QStringList      Db::mPaperIds;
 	QStringList      Db::mPaperNames;
+	QHash<QString,Paper*> Db::mPaperIdIndex;
+	QHash<QString,Paper*> Db::mPaperNameIndex;
 	QList<Category*> Db::mCategories;
 	QStringList      Db::mCategoryIds;
 	QStringList      Db::mCategoryNames;
+	QHash<QString,Category*> Db::mCategoryIdIndex;
+	QHash<QString,Category*> Db::mCategoryNameIndex;
 	QList<Vendor*>   Db::mVendors;
 	QStringList      Db::mVendorNames;
+	QHash<QString,Vendor*> Db::mVendorNameIndex;
 	QList<Template*> Db::mTemplates;
+	QHash<QString,Template*> Db::mTemplateNameIndex;
+	QHash<QPair<QString,QString>,Template*> Db::mTemplateBrandPartIndex;
+	QHash<QString,QList<Template*>> Db::mTemplateGeometryIndex;
+	QFileSystemWatcher*              Db::mUserTemplatesWatcher = nullptr;
+	QHash<QString,QList<Template*>> Db::mUserTemplateFiles;
+	QHash<QString,QString>          Db::mUserTemplateFileStamps;
+	QList<Template*>                Db::mRetiredTemplates;
 	QString          Db::mPaperNameOther;
 
 	
@@ -68,10 +120,18 @@ namespace glabels
 	{
 		mPaperNameOther = tr("Other");
 
-		readPapers();
-		readCategories();
-		readVendors();
-		readTemplates();
+		QFileInfoList sources = sourceFiles();
+		if ( !DbCache::read( sources ) )
+		{
+			readPapers();
+			readCategories();
+			readVendors();
+			readTemplates();
+
+			DbCache::write( sources );
+		}
+
+		readUserTemplates();
 	}
 
 
@@ -149,6 +209,12 @@ namespace glabels
 			mPapers << paper;
 			mPaperIds << paper->id();
 			mPaperNames << paper->name();
+
+			mPaperIdIndex.insert( paper->id(), paper );
+			if ( !mPaperNameIndex.contains( paper->name() ) )
+			{
+				mPaperNameIndex.insert( paper->name(), paper );
+			}
 		}
 		else
 		{
@@ -165,12 +231,9 @@ namespace glabels
 			return mPapers.first();
 		}
 
-		foreach ( Paper *paper, mPapers )
+		if ( Paper *paper = mPaperNameIndex.value( name ) )
 		{
-			if ( paper->name() == name )
-			{
-				return paper;
-			}
+			return paper;
 		}
 
 		qWarning() << "Unknown paper name: " << name;
@@ -186,12 +249,9 @@ namespace glabels
 			return mPapers.first();
 		}
 
-		foreach ( Paper *paper, mPapers )
+		if ( Paper *paper = mPaperIdIndex.value( id ) )
 		{
-			if ( paper->id() == id )
-			{
-				return paper;
-			}
+			return paper;
 		}
 
 		qWarning() << "Unknown paper ID: " << id;
@@ -238,15 +298,7 @@ namespace glabels
 
 	bool Db::isPaperIdKnown( const QString& id )
 	{
-		foreach ( Paper *paper, mPapers )
-		{
-			if ( paper->id() == id )
-			{
-				return true;
-			}
-		}
-
-		return false;
+		return mPaperIdIndex.contains( id );
 	}
 
 
@@ -263,6 +315,12 @@ namespace glabels
 			mCategories << category;
 			mCategoryIds << category->id();
 			mCategoryNames << category->name();
+
+			mCategoryIdIndex.insert( category->id(), category );
+			if ( !mCategoryNameIndex.contains( category->name() ) )
+			{
+				mCategoryNameIndex.insert( category->name(), category );
+			}
 		}
 		else
 		{
@@ -279,12 +337,9 @@ namespace glabels
 			return mCategories.first();
 		}
 
-		foreach ( Category *category, mCategories )
+		if ( Category *category = mCategoryNameIndex.value( name ) )
 		{
-			if ( category->name() == name )
-			{
-				return category;
-			}
+			return category;
 		}
 
 		qWarning() << "Unknown category name: \"%s\"." << name;
@@ -300,12 +355,9 @@ namespace glabels
 			return mCategories.first();
 		}
 
-		foreach ( Category *category, mCategories )
+		if ( Category *category = mCategoryIdIndex.value( id ) )
 		{
-			if ( category->id() == id )
-			{
-				return category;
-			}
+			return category;
 		}
 
 		qWarning() << "Unknown category ID: " << id;
@@ -347,15 +399,7 @@ namespace glabels
 
 	bool Db::isCategoryIdKnown( const QString& id )
 	{
-		foreach ( Category *category, mCategories )
-		{
-			if ( category->id() == id )
-			{
-				return true;
-			}
-		}
-
-		return false;
+		return mCategoryIdIndex.contains( id );
 	}
 
 
@@ -365,6 +409,8 @@ namespace glabels
 		{
 			mVendors << vendor;
 			mVendorNames << vendor->name();
+
+			mVendorNameIndex.insert( vendor->name(), vendor );
 		}
 		else
 		{
@@ -381,12 +427,9 @@ namespace glabels
 			return mVendors.first();
 		}
 
-		foreach ( Vendor *vendor, mVendors )
+		if ( Vendor *vendor = mVendorNameIndex.value( name ) )
 		{
-			if ( vendor->name() == name )
-			{
-				return vendor;
-			}
+			return vendor;
 		}
 
 		qWarning() << "Unknown vendor name: " << name;
@@ -412,32 +455,59 @@ namespace glabels
 
 	bool Db::isVendorNameKnown( const QString& name )
 	{
-		foreach ( Vendor *vendor, mVendors )
-		{
-			if ( vendor->name() == name )
-			{
-				return true;
-			}
-		}
-
-		return false;
+		return mVendorNameIndex.contains( name );
 	}
 
 
-	void Db::registerTemplate( Template *tmplate )
+	bool Db::registerTemplate( Template *tmplate )
 	{
 		if ( !isTemplateKnown( tmplate->brand(), tmplate->part() ) )
 		{
-			tmplate->initPreview();
 			mTemplates << tmplate;
+
+			mTemplateBrandPartIndex.insert( qMakePair( tmplate->brand(), tmplate->part() ), tmplate );
+			if ( !mTemplateNameIndex.contains( tmplate->name() ) )
+			{
+				mTemplateNameIndex.insert( tmplate->name(), tmplate );
+			}
+			if ( !tmplate->frames().isEmpty() )
+			{
+				mTemplateGeometryIndex[ geometryKey( tmplate ) ] << tmplate;
+			}
+			return true;
 		}
 		else
 		{
 			qWarning() << "Duplicate template name: " << tmplate->name();
+			return false;
 		}
 	}
 
 
+	void Db::unregisterTemplate( Template *tmplate )
+	{
+		mTemplates.removeOne( tmplate );
+
+		mTemplateBrandPartIndex.remove( qMakePair( tmplate->brand(), tmplate->part() ) );
+		if ( mTemplateNameIndex.value( tmplate->name() ) == tmplate )
+		{
+			mTemplateNameIndex.remove( tmplate->name() );
+		}
+		if ( !tmplate->frames().isEmpty() )
+		{
+			QString key = geometryKey( tmplate );
+			mTemplateGeometryIndex[ key ].removeOne( tmplate );
+			if ( mTemplateGeometryIndex[ key ].isEmpty() )
+			{
+				mTemplateGeometryIndex.remove( key );
+			}
+		}
+
+		// Open labels may still use it, see purgeRetiredTemplates()
+		mRetiredTemplates << tmplate;
+	}
+
+
 	const Template *Db::lookupTemplateFromName( const QString& name )
 	{
 		if ( name.isNull() || name.isEmpty() )
@@ -446,12 +516,9 @@ namespace glabels
 			return mTemplates.first();
 		}
 
-		foreach ( Template *tmplate, mTemplates )
+		if ( Template *tmplate = mTemplateNameIndex.value( name ) )
 		{
-			if ( tmplate->name() == name )
-			{
-				return tmplate;
-			}
+			return tmplate;
 		}
 
 		qWarning() << "Unknown template name: " << name;
@@ -467,12 +534,9 @@ namespace glabels
 			return mTemplates.first();
 		}
 
-		foreach ( Template *tmplate, mTemplates )
+		if ( Template *tmplate = mTemplateBrandPartIndex.value( qMakePair( brand, part ) ) )
 		{
-			if ( (tmplate->brand() == brand) && (tmplate->part() == part) )
-			{
-				return tmplate;
-			}
+			return tmplate;
 		}
 
 		qWarning() << "Unknown template brand, part: " << brand << ", " << part;
@@ -482,15 +546,7 @@ namespace glabels
 
 	bool Db::isTemplateKnown( const QString& brand, const QString& part )
 	{
-		foreach ( Template *tmplate, mTemplates )
-		{
-			if ( (tmplate->brand() == brand) && (tmplate->part() == part) )
-			{
-				return true;
-			}
-		}
-
-		return false;
+		return mTemplateBrandPartIndex.contains( qMakePair( brand, part ) );
 	}
 
 
@@ -505,7 +561,25 @@ namespace glabels
 			return list;
 		}
 
-		foreach (const Template *tmplate2, mTemplates )
+		if ( tmplate1->frames().isEmpty() )
+		{
+			return list;
+		}
+
+		// Only templates in this and adjacent geometry buckets can be similar
+		QList<Template*> candidates;
+		for ( int wOffset = -1; wOffset <= 1; wOffset++ )
+		{
+			for ( int hOffset = -1; hOffset <= 1; hOffset++ )
+			{
+				candidates << mTemplateGeometryIndex.value( geometryKey( tmplate1, wOffset, hOffset ) );
+			}
+		}
+
+		// Same order as a scan of mTemplates would give
+		qStableSort( candidates.begin(), candidates.end(), partNameLessThan );
+
+		foreach ( const Template *tmplate2, candidates )
 		{
 			if ( tmplate1->name() != tmplate2->name() )
 			{
@@ -520,21 +594,92 @@ namespace glabels
 	}
 
 
-	void Db::registerUserTemplate( Template *templat )
+	void Db::registerUserTemplate( Template *tmplate )
 	{
-		// TODO
+		QString baseName = QString( "%1_%2" ).arg( tmplate->brand() ).arg( tmplate->part() );
+		baseName.replace( QRegExp( "[\\s/\\\\]" ), "_" );
+
+		QString path = FileUtil::userTemplatesDir().absoluteFilePath( baseName + ".template" );
+
+		if ( !XmlTemplateCreator().writeTemplate( tmplate, path ) )
+		{
+			qWarning() << "Cannot write user template file" << path;
+			return;
+		}
+
+		// Picked up from the file just written, as if it had changed on disk
+		if ( reloadUserTemplateFile( path ) )
+		{
+			notifyChanged();
+		}
 	}
 
 
 	void Db::deleteUserTemplateByName( const QString& name )
 	{
-		// TODO
+		const Template *tmplate = mTemplateNameIndex.value( name );
+		if ( tmplate == nullptr )
+		{
+			qWarning() << "Unknown template name: " << name;
+			return;
+		}
+
+		deleteUserTemplateByBrandPart( tmplate->brand(), tmplate->part() );
 	}
 
 
 	void Db::deleteUserTemplateByBrandPart( const QString& brand, const QString& part )
 	{
-		// TODO
+		Template *tmplate = mTemplateBrandPartIndex.value( qMakePair( brand, part ) );
+
+		QString path;
+		for ( auto it = mUserTemplateFiles.constBegin(); it != mUserTemplateFiles.constEnd(); ++it )
+		{
+			if ( tmplate && it.value().contains( tmplate ) )
+			{
+				path = it.key();
+				break;
+			}
+		}
+
+		if ( path.isEmpty() )
+		{
+			qWarning() << "Not a user template: " << brand << ", " << part;
+			return;
+		}
+
+		QList<const Template*> remaining;
+		foreach ( Template *other, mUserTemplateFiles.value( path ) )
+		{
+			if ( other != tmplate )
+			{
+				remaining << other;
+			}
+		}
+
+		if ( remaining.isEmpty() )
+		{
+			if ( !QFile::remove( path ) )
+			{
+				qWarning() << "Cannot remove user template file" << path;
+				return;
+			}
+			unloadUserTemplateFile( path );
+			DbCache::removeUserTemplates( path );
+			notifyChanged();
+		}
+		else
+		{
+			if ( !XmlTemplateCreator().writeTemplates( remaining, path ) )
+			{
+				qWarning() << "Cannot write user template file" << path;
+				return;
+			}
+			if ( reloadUserTemplateFile( path ) )
+			{
+				notifyChanged();
+			}
+		}
 	}
 
 
@@ -602,6 +747,16 @@ namespace glabels
 	}
 
 
+	QFileInfoList Db::sourceFiles()
+	{
+		QStringList filters;
+		filters << "paper-sizes.xml" << "categories.xml" << "vendors.xml"
+		        << "*-templates.xml" << "*.template";
+
+		return FileUtil::systemTemplatesDir().entryInfoList( filters, QDir::Files, QDir::Name );
+	}
+
+
 	void Db::readPapers()
 	{
 		readPapersFromDir( FileUtil::systemTemplatesDir() );
@@ -666,8 +821,6 @@ namespace glabels
 	{
 		readTemplatesFromDir( FileUtil::systemTemplatesDir() );
 
-		// TODO: Read user directories
-
 		qStableSort( mTemplates.begin(), mTemplates.end(), partNameLessThan );
 	}
 
@@ -677,12 +830,221 @@ namespace glabels
 		QStringList filters;
 		filters << "*-templates.xml" << "*.template";
 
+		QStringList filePaths;
+		foreach ( QString fileName, dir.entryList( filters, QDir::Files ) )
+		{
+			filePaths << dir.absoluteFilePath( fileName );
+		}
+
+		// Parse files concurrently, but register their templates here, one
+		// file at a time in directory order, so duplicate and equivalent
+		// template handling is the same as when reading serially.
+		QList<XmlTemplateParser::ParsedFile> parsedFiles =
+			QtConcurrent::blockingMapped< QList<XmlTemplateParser::ParsedFile> >( filePaths, parseTemplateFile );
+
 		XmlTemplateParser parser;
+		foreach ( const XmlTemplateParser::ParsedFile& parsed, parsedFiles )
+		{
+			parser.registerTemplates( parsed );
+		}
+	}
 
-		foreach ( QString fileName, dir.entryList( filters, QDir::Files ) )
+
+
+	void Db::readUserTemplates()
+	{
+		QDir dir = FileUtil::userTemplatesDir();
+
+		QFileInfoList files = dir.entryInfoList( QStringList() << "*.template", QDir::Files, QDir::Name );
+
+		// Files unchanged since the last run come from the cache, the rest are parsed
+		QHash<QString,QList<Template*>> cached = DbCache::readUserTemplates( files );
+
+		mUserTemplatesWatcher = new QFileSystemWatcher( this );
+		mUserTemplatesWatcher->addPath( dir.absolutePath() );
+
+		foreach ( QFileInfo fileInfo, files )
+		{
+			QString path = fileInfo.absoluteFilePath();
+
+			QList<Template*> registered;
+			if ( cached.contains( path ) )
+			{
+				foreach ( Template *tmplate, cached.value( path ) )
+				{
+					if ( registerTemplate( tmplate ) )
+					{
+						registered << tmplate;
+					}
+					else
+					{
+						delete tmplate;
+					}
+				}
+			}
+			else
+			{
+				XmlTemplateParser parser;
+				XmlTemplateParser::ParsedFile parsed;
+				if ( parser.parseFile( path, parsed ) )
+				{
+					registered = parser.registerTemplates( parsed );
+				}
+				DbCache::writeUserTemplates( path, registered );
+			}
+
+			mUserTemplateFiles.insert( path, registered );
+			mUserTemplateFileStamps.insert( path, userTemplateFileStamp( path ) );
+			mUserTemplatesWatcher->addPath( path );
+		}
+
+		connect( mUserTemplatesWatcher, SIGNAL(directoryChanged(const QString&)),
+		         this, SLOT(onUserTemplatesDirChanged(const QString&)) );
+		connect( mUserTemplatesWatcher, SIGNAL(fileChanged(const QString&)),
+		         this, SLOT(onUserTemplateFileChanged(const QString&)) );
+
+		qStableSort( mTemplates.begin(), mTemplates.end(), partNameLessThan );
+	}
+
+
+	///
+	/// Re-read one user template file, returns false if it is unchanged
+	///
+	bool Db::reloadUserTemplateFile( const QString& path )
+	{
+		QString stamp = userTemplateFileStamp( path );
+		if ( mUserTemplateFiles.contains( path ) && (stamp == mUserTemplateFileStamps.value( path )) )
+		{
+			return false;
+		}
+
+		unloadUserTemplateFile( path );
+
+		if ( QFileInfo::exists( path ) )
+		{
+			XmlTemplateParser parser;
+			XmlTemplateParser::ParsedFile parsed;
+
+			QList<Template*> registered;
+			if ( parser.parseFile( path, parsed ) )
+			{
+				registered = parser.registerTemplates( parsed );
+			}
+
+			mUserTemplateFiles.insert( path, registered );
+			mUserTemplateFileStamps.insert( path, stamp );
+
+			// Editors that replace the file drop it from the watcher
+			if ( !mUserTemplatesWatcher->files().contains( path ) )
+			{
+				mUserTemplatesWatcher->addPath( path );
+			}
+
+			qStableSort( mTemplates.begin(), mTemplates.end(), partNameLessThan );
+
+			DbCache::writeUserTemplates( path, registered );
+		}
+		else
+		{
+			DbCache::removeUserTemplates( path );
+		}
+
+		return true;
+	}
+
+
+	void Db::unloadUserTemplateFile( const QString& path )
+	{
+		foreach ( Template *tmplate, mUserTemplateFiles.take( path ) )
+		{
+			unregisterTemplate( tmplate );
+		}
+		mUserTemplateFileStamps.remove( path );
+	}
+
+
+	void Db::notifyChanged()
+	{
+		emit instance()->changed();
+
+		// Listeners have let go of the replaced templates by now
+		instance()->purgeRetiredTemplates();
+	}
+
+
+	QString Db::userTemplateFileStamp( const QString& path )
+	{
+		QFileInfo fileInfo( path );
+		return QString( "%1:%2" ).arg( fileInfo.size() ).arg( fileInfo.lastModified().toMSecsSinceEpoch() );
+	}
+
+
+	void Db::onUserTemplatesDirChanged( const QString& path )
+	{
+		QDir dir( path );
+
+		QSet<QString> currentPaths;
+		foreach ( QFileInfo fileInfo, dir.entryInfoList( QStringList() << "*.template", QDir::Files ) )
 		{
-			parser.readFile( dir.absoluteFilePath( fileName ) );
+			currentPaths << fileInfo.absoluteFilePath();
+		}
+
+		bool anyChanged = false;
+		foreach ( QString knownPath, mUserTemplateFiles.keys() )
+		{
+			if ( !currentPaths.contains( knownPath ) )
+			{
+				unloadUserTemplateFile( knownPath );
+				DbCache::removeUserTemplates( knownPath );
+				anyChanged = true;
+			}
+		}
+
+		foreach ( QString newPath, currentPaths )
+		{
+			if ( !mUserTemplateFiles.contains( newPath ) )
+			{
+				anyChanged |= reloadUserTemplateFile( newPath );
+			}
+		}
+
+		if ( anyChanged )
+		{
+			notifyChanged();
+		}
+	}
+
+
+	void Db::onUserTemplateFileChanged( const QString& path )
+	{
+		if ( reloadUserTemplateFile( path ) )
+		{
+			notifyChanged();
+		}
+	}
+
+
+	///
+	/// Delete replaced or removed templates that no label uses any longer
+	///
+	/// Also invoked (queued) by LabelModel when it lets go of the last use of
+	/// a template.
+	///
+	void Db::purgeRetiredTemplates()
+	{
+		QList<Template*> inUse;
+		foreach ( Template* tmplate, mRetiredTemplates )
+		{
+			if ( LabelModel::isTemplateInUse( tmplate ) )
+			{
+				inUse << tmplate;
+			}
+			else
+			{
+				delete tmplate;
+			}
 		}
+		mRetiredTemplates = inUse;
 	}
 
 } // namespace glabels
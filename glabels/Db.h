@@ -27,18 +27,22 @@
 #include "Template.h"
 #include "Vendor.h"
 
-#include <QCoreApplication>
 #include <QDir>
+#include <QFileInfoList>
+#include <QFileSystemWatcher>
+#include <QHash>
 #include <QList>
+#include <QObject>
+#include <QPair>
 #include <QString>
 
 
 namespace glabels
 {
 
-	class Db
+	class Db : public QObject
 	{
-		Q_DECLARE_TR_FUNCTIONS(Db)
+		Q_OBJECT
 
 	private:
 		Db();
@@ -83,7 +87,7 @@ namespace glabels
 		static QString lookupVendorUrlFromName( const QString& name );
 		static bool isVendorNameKnown( const QString& id );
 
-		static void registerTemplate( Template *tmplate );
+		static bool registerTemplate( Template *tmplate );
 		static const Template *lookupTemplateFromName( const QString& name );
 		static const Template *lookupTemplateFromBrandPart( const QString& brand,
 		                                                    const QString& part );
@@ -101,8 +105,18 @@ namespace glabels
 		static void printKnownTemplates();
 
 
+	signals:
+		///
+		/// Emitted after user templates have been added, changed or removed.
+		/// Anything holding Template pointers from templates() must drop
+		/// them; replaced templates are deleted once no LabelModel uses them.
+		///
+		void changed();
+
+
 	private:
 		static QDir systemTemplatesDir();
+		static QFileInfoList sourceFiles();
 
 		static void readPapers();
 		static void readPapersFromDir( const QDir& dir );
@@ -116,20 +130,46 @@ namespace glabels
 		static void readTemplates();
 		static void readTemplatesFromDir( const QDir& dir );
 
+		void readUserTemplates();
+		static bool reloadUserTemplateFile( const QString& path );
+		static void unloadUserTemplateFile( const QString& path );
+		static void unregisterTemplate( Template *tmplate );
+		static void notifyChanged();
+		static QString userTemplateFileStamp( const QString& path );
+
+
+	private slots:
+		void onUserTemplatesDirChanged( const QString& path );
+		void onUserTemplateFileChanged( const QString& path );
+		void purgeRetiredTemplates();
+
 
 	private:
 		static QList<Paper*>    mPapers;
 		static QStringList      mPaperIds;
 		static QStringList      mPaperNames;
+		static QHash<QString,Paper*> mPaperIdIndex;
+		static QHash<QString,Paper*> mPaperNameIndex;
 
 		static QList<Category*> mCategories;
 		static QStringList      mCategoryIds;
 		static QStringList      mCategoryNames;
+		static QHash<QString,Category*> mCategoryIdIndex;
+		static QHash<QString,Category*> mCategoryNameIndex;
 
 		static QList<Vendor*>   mVendors;
 		static QStringList      mVendorNames;
+		static QHash<QString,Vendor*> mVendorNameIndex;
 
 		static QList<Template*> mTemplates;
+		static QHash<QString,Template*> mTemplateNameIndex;
+		static QHash<QPair<QString,QString>,Template*> mTemplateBrandPartIndex;
+		static QHash<QString,QList<Template*>> mTemplateGeometryIndex;
+
+		static QFileSystemWatcher*              mUserTemplatesWatcher;
+		static QHash<QString,QList<Template*>> mUserTemplateFiles;
+		static QHash<QString,QString>          mUserTemplateFileStamps;
+		static QList<Template*>                mRetiredTemplates;
 
 		static QString          mPaperNameOther;
 
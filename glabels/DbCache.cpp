@@ -0,0 +1,682 @@
+/*  DbCache.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DbCache.h"
+
+#include "Db.h"
+#include "FileUtil.h"
+#include "FrameCd.h"
+#include "FrameEllipse.h"
+#include "FrameRect.h"
+#include "FrameRound.h"
+#include "Layout.h"
+#include "Markup.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+#include <QtDebug>
+
+
+namespace glabels
+{
+
+	//
+	// Private
+	//
+	namespace
+	{
+		const quint32 magic   = 0x474c4442; // "GLDB"
+		const quint32 version = 1;
+
+		const QString cacheFileName    = "templates.cache";
+		const QString userCacheDirName = "user-templates";
+
+		enum FrameType { FRAME_RECT, FRAME_ROUND, FRAME_ELLIPSE, FRAME_CD };
+
+		enum MarkupType { MARKUP_MARGIN, MARKUP_LINE, MARKUP_RECT, MARKUP_ELLIPSE, MARKUP_CIRCLE };
+
+
+		QString cacheFilePath()
+		{
+			return FileUtil::cacheDir().absoluteFilePath( cacheFileName );
+		}
+
+
+		// One cache file per user template file, named after a hash of its path
+		QString userCacheFilePath( const QString& path )
+		{
+			QByteArray hash = QCryptographicHash::hash( path.toUtf8(), QCryptographicHash::Sha1 ).toHex();
+			return FileUtil::cacheDir().absoluteFilePath( userCacheDirName + "/" + QString( hash ) + ".cache" );
+		}
+
+
+		QByteArray createStamp( const QFileInfoList& sourceFiles )
+		{
+			QByteArray stamp;
+			QDataStream out( &stamp, QIODevice::WriteOnly );
+			out.setVersion( QDataStream::Qt_5_4 );
+
+			out << QLocale().name();
+			foreach ( QFileInfo fileInfo, sourceFiles )
+			{
+				out << fileInfo.absoluteFilePath()
+				    << fileInfo.size()
+				    << fileInfo.lastModified().toMSecsSinceEpoch();
+			}
+
+			return stamp;
+		}
+
+
+		void writeDistance( QDataStream& out, const Distance& d )
+		{
+			out << d.pt();
+		}
+
+
+		Distance readDistance( QDataStream& in )
+		{
+			double pts;
+			in >> pts;
+			return Distance::pt( pts );
+		}
+
+
+		void writeFrame( QDataStream& out, const Frame* frame )
+		{
+			if ( auto* rect = dynamic_cast<const FrameRect*>( frame ) )
+			{
+				out << quint8(FRAME_RECT) << frame->id();
+				writeDistance( out, rect->w() );
+				writeDistance( out, rect->h() );
+				writeDistance( out, rect->r() );
+				writeDistance( out, rect->xWaste() );
+				writeDistance( out, rect->yWaste() );
+			}
+			else if ( auto* round = dynamic_cast<const FrameRound*>( frame ) )
+			{
+				out << quint8(FRAME_ROUND) << frame->id();
+				writeDistance( out, round->r() );
+				writeDistance( out, round->waste() );
+			}
+			else if ( auto* ellipse = dynamic_cast<const FrameEllipse*>( frame ) )
+			{
+				out << quint8(FRAME_ELLIPSE) << frame->id();
+				writeDistance( out, ellipse->w() );
+				writeDistance( out, ellipse->h() );
+				writeDistance( out, ellipse->waste() );
+			}
+			else if ( auto* cd = dynamic_cast<const FrameCd*>( frame ) )
+			{
+				out << quint8(FRAME_CD) << frame->id();
+				writeDistance( out, cd->r1() );
+				writeDistance( out, cd->r2() );
+				writeDistance( out, cd->w() );
+				writeDistance( out, cd->h() );
+				writeDistance( out, cd->waste() );
+			}
+
+			out << quint32( frame->layouts().size() );
+			foreach ( Layout* layout, frame->layouts() )
+			{
+				out << qint32( layout->nx() ) << qint32( layout->ny() );
+				writeDistance( out, layout->x0() );
+				writeDistance( out, layout->y0() );
+				writeDistance( out, layout->dx() );
+				writeDistance( out, layout->dy() );
+			}
+
+			out << quint32( frame->markups().size() );
+			foreach ( Markup* markup, frame->markups() )
+			{
+				if ( auto* margin = dynamic_cast<MarkupMargin*>( markup ) )
+				{
+					out << quint8(MARKUP_MARGIN);
+					writeDistance( out, margin->size() );
+				}
+				else if ( auto* line = dynamic_cast<MarkupLine*>( markup ) )
+				{
+					out << quint8(MARKUP_LINE);
+					writeDistance( out, line->x1() );
+					writeDistance( out, line->y1() );
+					writeDistance( out, line->x2() );
+					writeDistance( out, line->y2() );
+				}
+				else if ( auto* rect = dynamic_cast<MarkupRect*>( markup ) )
+				{
+					out << quint8(MARKUP_RECT);
+					writeDistance( out, rect->x1() );
+					writeDistance( out, rect->y1() );
+					writeDistance( out, rect->w() );
+					writeDistance( out, rect->h() );
+					writeDistance( out, rect->r() );
+				}
+				else if ( auto* ellipse = dynamic_cast<MarkupEllipse*>( markup ) )
+				{
+					out << quint8(MARKUP_ELLIPSE);
+					writeDistance( out, ellipse->x1() );
+					writeDistance( out, ellipse->y1() );
+					writeDistance( out, ellipse->w() );
+					writeDistance( out, ellipse->h() );
+				}
+				else if ( auto* circle = dynamic_cast<MarkupCircle*>( markup ) )
+				{
+					out << quint8(MARKUP_CIRCLE);
+					writeDistance( out, circle->x0() );
+					writeDistance( out, circle->y0() );
+					writeDistance( out, circle->r() );
+				}
+			}
+		}
+
+
+		Frame* readFrame( QDataStream& in )
+		{
+			quint8  type;
+			QString id;
+			in >> type >> id;
+
+			Frame* frame = nullptr;
+			switch ( type )
+			{
+			case FRAME_RECT:
+				{
+					Distance w      = readDistance( in );
+					Distance h      = readDistance( in );
+					Distance r      = readDistance( in );
+					Distance xWaste = readDistance( in );
+					Distance yWaste = readDistance( in );
+					frame = new FrameRect( w, h, r, xWaste, yWaste, id );
+				}
+				break;
+			case FRAME_ROUND:
+				{
+					Distance r     = readDistance( in );
+					Distance waste = readDistance( in );
+					frame = new FrameRound( r, waste, id );
+				}
+				break;
+			case FRAME_ELLIPSE:
+				{
+					Distance w     = readDistance( in );
+					Distance h     = readDistance( in );
+					Distance waste = readDistance( in );
+					frame = new FrameEllipse( w, h, waste, id );
+				}
+				break;
+			case FRAME_CD:
+				{
+					Distance r1    = readDistance( in );
+					Distance r2    = readDistance( in );
+					Distance w     = readDistance( in );
+					Distance h     = readDistance( in );
+					Distance waste = readDistance( in );
+					frame = new FrameCd( r1, r2, w, h, waste, id );
+				}
+				break;
+			default:
+				qWarning() << "Template cache: bad frame type" << type;
+				in.setStatus( QDataStream::ReadCorruptData );
+				return nullptr;
+			}
+
+			quint32 nLayouts;
+			in >> nLayouts;
+			for ( quint32 i = 0; i < nLayouts; i++ )
+			{
+				qint32 nx, ny;
+				in >> nx >> ny;
+				Distance x0 = readDistance( in );
+				Distance y0 = readDistance( in );
+				Distance dx = readDistance( in );
+				Distance dy = readDistance( in );
+				frame->addLayout( new Layout( nx, ny, x0, y0, dx, dy ) );
+			}
+
+			quint32 nMarkups;
+			in >> nMarkups;
+			for ( quint32 i = 0; i < nMarkups; i++ )
+			{
+				quint8 markupType;
+				in >> markupType;
+				switch ( markupType )
+				{
+				case MARKUP_MARGIN:
+					{
+						Distance size = readDistance( in );
+						frame->addMarkup( new MarkupMargin( frame, size ) );
+					}
+					break;
+				case MARKUP_LINE:
+					{
+						Distance x1 = readDistance( in );
+						Distance y1 = readDistance( in );
+						Distance x2 = readDistance( in );
+						Distance y2 = readDistance( in );
+						frame->addMarkup( new MarkupLine( x1, y1, x2, y2 ) );
+					}
+					break;
+				case MARKUP_RECT:
+					{
+						Distance x1 = readDistance( in );
+						Distance y1 = readDistance( in );
+						Distance w  = readDistance( in );
+						Distance h  = readDistance( in );
+						Distance r  = readDistance( in );
+						frame->addMarkup( new MarkupRect( x1, y1, w, h, r ) );
+					}
+					break;
+				case MARKUP_ELLIPSE:
+					{
+						Distance x1 = readDistance( in );
+						Distance y1 = readDistance( in );
+						Distance w  = readDistance( in );
+						Distance h  = readDistance( in );
+						frame->addMarkup( new MarkupEllipse( x1, y1, w, h ) );
+					}
+					break;
+				case MARKUP_CIRCLE:
+					{
+						Distance x0 = readDistance( in );
+						Distance y0 = readDistance( in );
+						Distance r  = readDistance( in );
+						frame->addMarkup( new MarkupCircle( x0, y0, r ) );
+					}
+					break;
+				default:
+					qWarning() << "Template cache: bad markup type" << markupType;
+					in.setStatus( QDataStream::ReadCorruptData );
+					return frame;
+				}
+			}
+
+			return frame;
+		}
+
+
+		void writeTemplate( QDataStream& out, const Template* tmplate )
+		{
+			out << tmplate->brand()
+			    << tmplate->part()
+			    << tmplate->description()
+			    << tmplate->paperId();
+			writeDistance( out, tmplate->pageWidth() );
+			writeDistance( out, tmplate->pageHeight() );
+			out << tmplate->equivPart()
+			    << tmplate->productUrl()
+			    << tmplate->categoryIds();
+
+			out << quint32( tmplate->frames().size() );
+			foreach ( Frame* frame, tmplate->frames() )
+			{
+				writeFrame( out, frame );
+			}
+		}
+
+
+		Template* readTemplate( QDataStream& in )
+		{
+			QString brand, part, description, paperId;
+			in >> brand >> part >> description >> paperId;
+			Distance pageWidth  = readDistance( in );
+			Distance pageHeight = readDistance( in );
+
+			QString     equivPart, productUrl;
+			QStringList categoryIds;
+			in >> equivPart >> productUrl >> categoryIds;
+
+			Template* tmplate = new Template( brand, part, description, paperId, pageWidth, pageHeight );
+			tmplate->setEquivPart( equivPart );
+			tmplate->setProductUrl( productUrl );
+			foreach ( QString categoryId, categoryIds )
+			{
+				tmplate->addCategory( categoryId );
+			}
+
+			quint32 nFrames;
+			in >> nFrames;
+			for ( quint32 i = 0; (i < nFrames) && (in.status() == QDataStream::Ok); i++ )
+			{
+				Frame* frame = readFrame( in );
+				if ( frame )
+				{
+					tmplate->addFrame( frame );
+				}
+			}
+
+			return tmplate;
+		}
+
+	}
+
+
+	///
+	/// Read database from cache, if it is current
+	///
+	bool DbCache::read( const QFileInfoList& sourceFiles )
+	{
+		QFile file( cacheFilePath() );
+		if ( !file.open( QIODevice::ReadOnly ) )
+		{
+			return false;
+		}
+
+		// Map the cache rather than reading it; it is only looked at once
+		uchar* data = file.map( 0, file.size() );
+		if ( data == nullptr )
+		{
+			qWarning() << "Template cache: cannot map" << file.fileName();
+			return false;
+		}
+
+		QByteArray bytes = QByteArray::fromRawData( reinterpret_cast<const char*>(data), int(file.size()) );
+		QBuffer buffer( &bytes );
+		buffer.open( QIODevice::ReadOnly );
+
+		QDataStream in( &buffer );
+		in.setVersion( QDataStream::Qt_5_4 );
+
+		quint32    fileMagic, fileVersion;
+		QByteArray stamp;
+		quint16    checksum;
+		in >> fileMagic >> fileVersion >> stamp >> checksum;
+
+		if ( (in.status() != QDataStream::Ok) ||
+		     (fileMagic != magic) || (fileVersion != version) ||
+		     (stamp != createStamp( sourceFiles )) )
+		{
+			// Stale or foreign cache, silently rebuild
+			return false;
+		}
+
+		qint64 payloadOffset = buffer.pos();
+		if ( qChecksum( bytes.constData() + payloadOffset, uint(bytes.size() - payloadOffset) ) != checksum )
+		{
+			qWarning() << "Template cache: checksum mismatch in" << file.fileName();
+			return false;
+		}
+
+		// Read everything before registering anything, so that a bad cache
+		// leaves Db empty and it can be rebuilt from the XML files.
+		QList<Paper*>    papers;
+		QList<Category*> categories;
+		QList<Vendor*>   vendors;
+		QList<Template*> tmplates;
+
+		quint32 nPapers;
+		in >> nPapers;
+		for ( quint32 i = 0; (i < nPapers) && (in.status() == QDataStream::Ok); i++ )
+		{
+			QString id, name, pwgSize;
+			in >> id >> name;
+			Distance width  = readDistance( in );
+			Distance height = readDistance( in );
+			in >> pwgSize;
+			papers << new Paper( id, name, width, height, pwgSize );
+		}
+
+		quint32 nCategories;
+		in >> nCategories;
+		for ( quint32 i = 0; (i < nCategories) && (in.status() == QDataStream::Ok); i++ )
+		{
+			QString id, name;
+			in >> id >> name;
+			categories << new Category( id, name );
+		}
+
+		quint32 nVendors;
+		in >> nVendors;
+		for ( quint32 i = 0; (i < nVendors) && (in.status() == QDataStream::Ok); i++ )
+		{
+			QString name, url;
+			in >> name >> url;
+			vendors << new Vendor( name, url );
+		}
+
+		// Templates are stored already sorted
+		quint32 nTemplates;
+		in >> nTemplates;
+		for ( quint32 i = 0; (i < nTemplates) && (in.status() == QDataStream::Ok); i++ )
+		{
+			tmplates << readTemplate( in );
+		}
+
+		if ( in.status() != QDataStream::Ok )
+		{
+			qWarning() << "Template cache: corrupt data in" << file.fileName();
+
+			qDeleteAll( papers );
+			qDeleteAll( categories );
+			qDeleteAll( vendors );
+			qDeleteAll( tmplates );
+			return false;
+		}
+
+		foreach ( Paper* paper, papers )
+		{
+			Db::registerPaper( paper );
+		}
+		foreach ( Category* category, categories )
+		{
+			Db::registerCategory( category );
+		}
+		foreach ( Vendor* vendor, vendors )
+		{
+			Db::registerVendor( vendor );
+		}
+		foreach ( Template* tmplate, tmplates )
+		{
+			Db::registerTemplate( tmplate );
+		}
+
+		return true;
+	}
+
+
+	///
+	/// Write current database to cache
+	///
+	void DbCache::write( const QFileInfoList& sourceFiles )
+	{
+		QByteArray payload;
+		QDataStream out( &payload, QIODevice::WriteOnly );
+		out.setVersion( QDataStream::Qt_5_4 );
+
+		out << quint32( Db::papers().size() );
+		foreach ( Paper* paper, Db::papers() )
+		{
+			out << paper->id() << paper->name();
+			writeDistance( out, paper->width() );
+			writeDistance( out, paper->height() );
+			out << paper->pwgSize();
+		}
+
+		out << quint32( Db::categories().size() );
+		foreach ( Category* category, Db::categories() )
+		{
+			out << category->id() << category->name();
+		}
+
+		out << quint32( Db::vendors().size() );
+		foreach ( Vendor* vendor, Db::vendors() )
+		{
+			out << vendor->name() << vendor->url();
+		}
+
+		out << quint32( Db::templates().size() );
+		foreach ( Template* tmplate, Db::templates() )
+		{
+			writeTemplate( out, tmplate );
+		}
+
+
+		QSaveFile file( cacheFilePath() );
+		if ( !file.open( QIODevice::WriteOnly ) )
+		{
+			qWarning() << "Template cache: cannot write" << file.fileName() << ":" << file.errorString();
+			return;
+		}
+
+		QDataStream header( &file );
+		header.setVersion( QDataStream::Qt_5_4 );
+		header << magic << version << createStamp( sourceFiles )
+		       << qChecksum( payload.constData(), uint(payload.size()) );
+
+		file.write( payload );
+
+		if ( !file.commit() )
+		{
+			qWarning() << "Template cache: cannot write" << file.fileName() << ":" << file.errorString();
+		}
+	}
+
+
+	///
+	/// Read cached templates of those user template files that are unchanged
+	///
+	QHash<QString,QList<Template*>> DbCache::readUserTemplates( const QFileInfoList& files )
+	{
+		QHash<QString,QList<Template*>> fileTemplates;
+
+		foreach ( QFileInfo fileInfo, files )
+		{
+			QFile file( userCacheFilePath( fileInfo.absoluteFilePath() ) );
+			if ( !file.open( QIODevice::ReadOnly ) )
+			{
+				continue;
+			}
+
+			QByteArray bytes = file.readAll();
+			QBuffer buffer( &bytes );
+			buffer.open( QIODevice::ReadOnly );
+
+			QDataStream in( &buffer );
+			in.setVersion( QDataStream::Qt_5_4 );
+
+			quint32 fileMagic, fileVersion;
+			QString locale;
+			quint16 checksum;
+			in >> fileMagic >> fileVersion >> locale >> checksum;
+
+			if ( (in.status() != QDataStream::Ok) ||
+			     (fileMagic != magic) || (fileVersion != version) || (locale != QLocale().name()) )
+			{
+				continue;
+			}
+
+			qint64 payloadOffset = buffer.pos();
+			if ( qChecksum( bytes.constData() + payloadOffset, uint(bytes.size() - payloadOffset) ) != checksum )
+			{
+				qWarning() << "Template cache: checksum mismatch in" << file.fileName();
+				continue;
+			}
+
+			QString path;
+			qint64  size, mtime;
+			quint32 nTemplates;
+			in >> path >> size >> mtime >> nTemplates;
+
+			if ( (path != fileInfo.absoluteFilePath()) ||
+			     (fileInfo.size() != size) ||
+			     (fileInfo.lastModified().toMSecsSinceEpoch() != mtime) )
+			{
+				continue;
+			}
+
+			QList<Template*> tmplates;
+			for ( quint32 j = 0; (j < nTemplates) && (in.status() == QDataStream::Ok); j++ )
+			{
+				tmplates << readTemplate( in );
+			}
+
+			if ( in.status() == QDataStream::Ok )
+			{
+				fileTemplates.insert( path, tmplates );
+			}
+			else
+			{
+				qDeleteAll( tmplates );
+			}
+		}
+
+		return fileTemplates;
+	}
+
+
+	///
+	/// Write cache of one user template file
+	///
+	void DbCache::writeUserTemplates( const QString& path, const QList<Template*>& tmplates )
+	{
+		QByteArray payload;
+		QDataStream out( &payload, QIODevice::WriteOnly );
+		out.setVersion( QDataStream::Qt_5_4 );
+
+		QFileInfo fileInfo( path );
+		out << path << fileInfo.size() << fileInfo.lastModified().toMSecsSinceEpoch();
+
+		out << quint32( tmplates.size() );
+		foreach ( Template* tmplate, tmplates )
+		{
+			writeTemplate( out, tmplate );
+		}
+
+		FileUtil::cacheDir().mkpath( userCacheDirName );
+
+		QSaveFile file( userCacheFilePath( path ) );
+		if ( !file.open( QIODevice::WriteOnly ) )
+		{
+			qWarning() << "Template cache: cannot write" << file.fileName() << ":" << file.errorString();
+			return;
+		}
+
+		QDataStream header( &file );
+		header.setVersion( QDataStream::Qt_5_4 );
+		header << magic << version << QLocale().name()
+		       << qChecksum( payload.constData(), uint(payload.size()) );
+
+		file.write( payload );
+
+		if ( !file.commit() )
+		{
+			qWarning() << "Template cache: cannot write" << file.fileName() << ":" << file.errorString();
+		}
+	}
+
+
+	///
+	/// Remove cache of one user template file
+	///
+	void DbCache::removeUserTemplates( const QString& path )
+	{
+		QFile file( userCacheFilePath( path ) );
+		if ( file.exists() && !file.remove() )
+		{
+			qWarning() << "Template cache: cannot remove" << file.fileName() << ":" << file.errorString();
+		}
+	}
+
+} // namespace glabels
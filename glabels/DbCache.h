@@ -0,0 +1,69 @@
+/*  DbCache.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DbCache_h
+#define DbCache_h
+
+
+#include <QFileInfoList>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+
+namespace glabels
+{
+
+	// Forward references
+	class Template;
+
+
+	///
+	/// Binary cache of the template database
+	///
+	/// Holds the papers, categories, vendors and templates read from the
+	/// system template files in a compact binary form, so that they need
+	/// not be parsed from XML on every launch.  The cache is stamped with
+	/// the name, size and modification time of every source file (and the
+	/// locale, since descriptions are translated); any difference causes
+	/// the cache to be ignored and rebuilt.
+	///
+	namespace DbCache
+	{
+
+		bool read( const QFileInfoList& sourceFiles );
+		void write( const QFileInfoList& sourceFiles );
+
+		///
+		/// User templates are cached in one cache file per template file, so
+		/// that a change to one file only rewrites that file's entry.  Returns
+		/// the (unregistered) templates of each file whose size and
+		/// modification time still match.
+		///
+		QHash<QString,QList<Template*>> readUserTemplates( const QFileInfoList& files );
+		void writeUserTemplates( const QString& path, const QList<Template*>& tmplates );
+		void removeUserTemplates( const QString& path );
+
+	}
+
+}
+
+
+#endif // DbCache_h
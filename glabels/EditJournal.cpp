@@ -0,0 +1,784 @@
+/*  EditJournal.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EditJournal.h"
+
+#include "DataCache.h"
+#include "FileUtil.h"
+#include "LabelModelObject.h"
+#include "XmlLabelCreator.h"
+#include "XmlLabelParser.h"
+
+#include "Merge/Merge.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QUuid>
+#include <QtConcurrent>
+#include <QtDebug>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+
+namespace glabels
+{
+
+	//
+	// Private
+	//
+	namespace
+	{
+		const char   journalMagic[]     = "GLJ1";
+		const int    journalMagicLength = 4;
+		const int    journalDelayMs     = 200;
+		const auto   journalStreamVersion = QDataStream::Qt_5_4;
+
+
+		bool syncToDisk( QFile* file )
+		{
+			if ( !file->flush() )
+			{
+				return false;
+			}
+
+#if defined(Q_OS_WIN)
+			return _commit( file->handle() ) == 0;
+#else
+			return fsync( file->handle() ) == 0;
+#endif
+		}
+
+
+		QList<qint32> toStreamIds( const QList<int>& ids )
+		{
+			QList<qint32> streamIds;
+			foreach ( int id, ids )
+			{
+				streamIds << qint32(id);
+			}
+			return streamIds;
+		}
+
+
+		QList<int> fromStreamIds( const QList<qint32>& streamIds )
+		{
+			QList<int> ids;
+			foreach ( qint32 id, streamIds )
+			{
+				ids << int(id);
+			}
+			return ids;
+		}
+
+
+		QByteArray dataKey( const QByteArray& data )
+		{
+			return QCryptographicHash::hash( data, QCryptographicHash::Sha1 );
+		}
+	}
+
+
+	///
+	/// Constructor
+	///
+	EditJournal::EditJournal( LabelModel* model )
+		: mModel(model), mLock(nullptr), mDiscarded(false), mPendingChanges(LabelModel::NoChanges)
+	{
+		QString name = QUuid::createUuid().toString().mid( 1, 36 ) + ".journal";
+		mPath = FileUtil::journalDir().filePath( name );
+
+		mLock = new QLockFile( mPath + ".lock" );
+		mLock->setStaleLockTime( 0 );
+		if ( !mLock->tryLock( 0 ) )
+		{
+			qWarning() << "Cannot lock edit journal" << mPath;
+		}
+
+		mFile.setFileName( mPath );
+		if ( !mFile.open( QIODevice::WriteOnly ) )
+		{
+			qWarning() << "Cannot open edit journal" << mPath << ":" << mFile.errorString();
+		}
+
+		mTimer.setSingleShot( true );
+		mTimer.setInterval( journalDelayMs );
+
+		connect( &mTimer, SIGNAL(timeout()), this, SLOT(onTimeout()) );
+		connect( &mWriteWatcher, SIGNAL(finished()), this, SLOT(onWriteFinished()) );
+		connect( mModel, SIGNAL(changed()), this, SLOT(onChanged()) );
+
+		reset();
+	}
+
+
+	///
+	/// Destructor
+	///
+	EditJournal::~EditJournal()
+	{
+		// Leave journal in place unless it has been explicitly discarded
+		mWriteWatcher.waitForFinished();
+		mFile.close();
+		delete mLock;
+	}
+
+
+	///
+	/// Start a new journal from current state of model (e.g. after a save)
+	///
+	void EditJournal::reset()
+	{
+		if ( mDiscarded )
+		{
+			return;
+		}
+
+		// Anything still queued is superseded by the new base
+		mQueue.clear();
+		mTimer.stop();
+		mPendingChanges = LabelModel::NoChanges;
+		mRevisions.clear();
+		mOrder.clear();
+
+		Entry header( HeaderEntry );
+		header.fileName = mModel->fileName();
+		mQueue << header;
+
+		if ( !mModel->fileName().isEmpty() && !mModel->isModified() )
+		{
+			// Saved file is the base, only need to know object identities
+			Entry base( FileBaseEntry );
+			base.fileName = mModel->fileName();
+			foreach ( LabelModelObject* object, mModel->objectList() )
+			{
+				base.ids << object->id();
+				mRevisions.insert( object->id(), object->revision() );
+			}
+			mOrder = base.ids;
+			mQueue << base;
+		}
+		else
+		{
+			recordProperties();
+			record();
+		}
+
+		mQueue << Entry( BaseEndEntry );
+
+		startWrite();
+	}
+
+
+	///
+	/// Stop journaling and delete journal (session closed normally)
+	///
+	void EditJournal::discard()
+	{
+		if ( mDiscarded )
+		{
+			return;
+		}
+		mDiscarded = true;
+
+		mTimer.stop();
+		mQueue.clear();
+		mWriteWatcher.waitForFinished();
+
+		mFile.close();
+		QFile::remove( mPath );
+		mLock->unlock();
+	}
+
+
+	///
+	/// Find journals left behind by sessions that did not shut down cleanly
+	///
+	QStringList EditJournal::orphanedJournals()
+	{
+		QStringList journals;
+
+		QDir dir = FileUtil::journalDir();
+		foreach ( QString name, dir.entryList( QStringList() << "*.journal", QDir::Files, QDir::Time ) )
+		{
+			QString path = dir.filePath( name );
+
+			// A journal still locked by a running process belongs to a live session
+			QLockFile lock( path + ".lock" );
+			lock.setStaleLockTime( 0 );
+			if ( lock.tryLock( 0 ) )
+			{
+				journals << path;
+				lock.unlock();
+			}
+		}
+
+		return journals;
+	}
+
+
+	///
+	/// Rebuild label from journal.  Returns nullptr if there is nothing to recover.
+	///
+	LabelModel* EditJournal::replay( const QString& journalPath )
+	{
+		QFile file( journalPath );
+		if ( !file.open( QIODevice::ReadOnly ) )
+		{
+			qWarning() << "Cannot read edit journal" << journalPath << ":" << file.errorString();
+			return nullptr;
+		}
+
+		QByteArray data = file.readAll();
+		if ( !data.startsWith( journalMagic ) )
+		{
+			return nullptr;
+		}
+
+		QDataStream in( data );
+		in.setVersion( journalStreamVersion );
+		in.skipRawData( journalMagicLength );
+
+		QString                 docFileName;
+		QString                 baseFileName;
+		QList<int>              baseIds;
+		QByteArray              properties;
+		QHash<QByteArray,QByteArray> dataEntries;
+		QHash<int,QByteArray>   objects;
+		QHash<int,DataCache>    objectData;
+		QList<int>              order;
+		bool                    inBase = true;
+		int                     nEdits = 0;
+
+		while ( !in.atEnd() )
+		{
+			quint32 size;
+			quint8  type;
+			in >> size >> type;
+
+			// A torn entry at the tail means we crashed mid-write; stop there
+			if ( (in.status() != QDataStream::Ok) ||
+			     (in.device()->bytesAvailable() < qint64(size) + qint64(sizeof(quint16))) )
+			{
+				break;
+			}
+
+			QByteArray payload( int(size), '\0' );
+			in.readRawData( payload.data(), int(size) );
+
+			quint16 checksum;
+			in >> checksum;
+			if ( checksum != qChecksum( payload.constData(), uint(payload.size()) ) )
+			{
+				break;
+			}
+
+			QDataStream entry( payload );
+			entry.setVersion( journalStreamVersion );
+
+			switch ( type )
+			{
+			case HeaderEntry:
+				entry >> docFileName;
+				baseFileName.clear();
+				baseIds.clear();
+				properties.clear();
+				dataEntries.clear();
+				objects.clear();
+				objectData.clear();
+				order.clear();
+				inBase = true;
+				nEdits = 0;
+				break;
+
+			case FileBaseEntry:
+			{
+				QList<qint32> ids;
+				entry >> baseFileName >> ids;
+				baseIds = fromStreamIds( ids );
+				order = baseIds;
+				break;
+			}
+
+			case PropertiesEntry:
+				entry >> properties;
+				break;
+
+			case DataEntry:
+			{
+				QByteArray key;
+				QByteArray bytes;
+				entry >> key >> bytes;
+				dataEntries.insert( key, bytes );
+				break;
+			}
+
+			case ObjectEntry:
+			{
+				qint32      id;
+				QByteArray  xml;
+				QStringList names;
+				QStringList mimetypes;
+				QList<QByteArray> keys;
+				entry >> id >> xml >> names >> mimetypes >> keys;
+				objects.insert( int(id), xml );
+
+				// Older entries have their data inline, and nothing to look up here
+				DataCache objectCache;
+				for ( int i = 0; (i < names.size()) && (i < mimetypes.size()) && (i < keys.size()); i++ )
+				{
+					if ( mimetypes[i] == "image/svg+xml" )
+					{
+						objectCache.addSvg( names[i], dataEntries.value( keys[i] ) );
+					}
+					else
+					{
+						objectCache.addImageData( names[i], dataEntries.value( keys[i] ) );
+					}
+				}
+				objectData.insert( int(id), objectCache );
+				break;
+			}
+
+			case OrderEntry:
+			{
+				QList<qint32> ids;
+				entry >> ids;
+				order = fromStreamIds( ids );
+				break;
+			}
+
+			case BaseEndEntry:
+				inBase = false;
+				break;
+
+			default:
+				qWarning() << "Unknown edit journal entry type" << type;
+				break;
+			}
+
+			if ( !inBase && (type != BaseEndEntry) && (type != DataEntry) )
+			{
+				nEdits++;
+			}
+		}
+
+		if ( nEdits == 0 )
+		{
+			return nullptr;
+		}
+
+		//
+		// Only now do the expensive part, once for each surviving object.
+		//
+		LabelModel* fileModel = nullptr;
+		if ( !baseFileName.isEmpty() )
+		{
+			fileModel = XmlLabelParser::readFile( baseFileName );
+			if ( !fileModel )
+			{
+				return nullptr;
+			}
+		}
+
+		LabelModel* propertiesModel = fileModel;
+		if ( !properties.isEmpty() )
+		{
+			propertiesModel = XmlLabelParser::readBuffer( qUncompress( properties ) );
+		}
+		if ( !propertiesModel )
+		{
+			delete fileModel;
+			return nullptr;
+		}
+
+		QList<LabelModelObject*> objectList;
+		QList<LabelModelObject*> parsedObjects;
+		foreach ( int id, order )
+		{
+			if ( objects.contains( id ) )
+			{
+				QList<LabelModelObject*> list =
+					XmlLabelParser::deserializeObjects( qUncompress( objects.value( id ) ), objectData.value( id ) );
+				parsedObjects << list;
+				objectList << list;
+			}
+			else if ( fileModel && baseIds.contains( id ) )
+			{
+				int i = baseIds.indexOf( id );
+				if ( i < fileModel->objectList().size() )
+				{
+					objectList << fileModel->objectList().at( i );
+				}
+			}
+		}
+
+		LabelModel* label = new LabelModel();
+		label->restore( propertiesModel, objectList, propertiesModel->merge() );
+		label->setFileName( docFileName );
+		label->setModified();
+
+		qDeleteAll( parsedObjects );
+		if ( propertiesModel != fileModel )
+		{
+			delete propertiesModel;
+		}
+		delete fileModel;
+
+		return label;
+	}
+
+
+	///
+	/// Delete an orphaned journal
+	///
+	void EditJournal::remove( const QString& journalPath )
+	{
+		QFile::remove( journalPath );
+		QFile::remove( journalPath + ".lock" );
+	}
+
+
+	///
+	/// Model changed handler
+	///
+	void EditJournal::onChanged()
+	{
+		if ( mDiscarded )
+		{
+			return;
+		}
+
+		mPendingChanges |= mModel->lastChanges();
+
+		// Collect changes for a short while, but do not postpone indefinitely
+		// during a continuous change such as dragging
+		if ( !mTimer.isActive() )
+		{
+			mTimer.start();
+		}
+	}
+
+
+	///
+	/// Timer handler
+	///
+	void EditJournal::onTimeout()
+	{
+		if ( mPendingChanges & (LabelModel::LabelChanged | LabelModel::MergeChanged) )
+		{
+			recordProperties();
+		}
+		mPendingChanges = LabelModel::NoChanges;
+
+		record();
+		startWrite();
+	}
+
+
+	///
+	/// Write job finished handler
+	///
+	void EditJournal::onWriteFinished()
+	{
+		if ( !mWriteWatcher.result() )
+		{
+			qWarning() << "Error writing edit journal" << mPath;
+		}
+
+		startWrite();
+	}
+
+
+	///
+	/// Queue entries for objects that changed since they were last journaled
+	///
+	void EditJournal::record()
+	{
+		QHash<int,quint64> revisions;
+		QList<int>         order;
+
+		foreach ( LabelModelObject* object, mModel->objectList() )
+		{
+			auto it = mRevisions.constFind( object->id() );
+			if ( (it == mRevisions.constEnd()) || (it.value() != object->revision()) )
+			{
+				recordObject( object );
+			}
+
+			revisions.insert( object->id(), object->revision() );
+			order << object->id();
+		}
+
+		mRevisions = revisions;
+
+		// Also covers removed objects, which simply drop out of the order
+		if ( order != mOrder )
+		{
+			Entry entry( OrderEntry );
+			entry.ids = order;
+			mQueue << entry;
+
+			mOrder = order;
+		}
+	}
+
+
+	///
+	/// Queue entry for label properties (template, rotation, merge)
+	///
+	void EditJournal::recordProperties()
+	{
+		// saveProperties() leaves out the merge, but it is part of what we journal
+		LabelModel* properties = mModel->saveProperties();
+		properties->setMerge( mModel->merge()->clone() );
+
+		Entry entry( PropertiesEntry );
+		entry.properties = QSharedPointer<LabelModel>( properties, &QObject::deleteLater );
+		mQueue << entry;
+	}
+
+
+	///
+	/// Queue entry for one object
+	///
+	void EditJournal::recordObject( LabelModelObject* object )
+	{
+		Entry entry( ObjectEntry );
+		entry.id     = object->id();
+		entry.object = QSharedPointer<LabelModelObject>( object->clone(), &QObject::deleteLater );
+		mQueue << entry;
+	}
+
+
+	///
+	/// Hand queued entries to a write job, unless one is already running
+	///
+	void EditJournal::startWrite()
+	{
+		if ( mDiscarded || mQueue.isEmpty() || mWriteWatcher.isRunning() )
+		{
+			return;
+		}
+
+		QList<Entry> entries = mQueue;
+		mQueue.clear();
+
+		mWriteWatcher.setFuture( QtConcurrent::run( &EditJournal::writeEntries, &mFile, &mJournaled, entries ) );
+	}
+
+
+	///
+	/// Serialize and append entries, then sync once for the whole batch (runs in worker thread)
+	///
+	bool EditJournal::writeEntries( QFile* file, JournaledData* journaled, const QList<Entry>& entries )
+	{
+		if ( !file->isOpen() )
+		{
+			return false;
+		}
+
+		QByteArray batch;
+		foreach ( const Entry& entry, entries )
+		{
+			if ( entry.type == HeaderEntry )
+			{
+				// Header starts a new journal; anything before it is obsolete
+				if ( !file->resize( 0 ) || !file->seek( 0 ) )
+				{
+					return false;
+				}
+				batch = QByteArray( journalMagic, journalMagicLength );
+				journaled->keys.clear();
+				journaled->imageKeys.clear();
+			}
+
+			if ( entry.type == ObjectEntry )
+			{
+				appendEntry( batch, entry.type, encodeObjectEntry( entry, journaled, batch ) );
+			}
+			else
+			{
+				appendEntry( batch, entry.type, encodeEntry( entry ) );
+			}
+		}
+
+		if ( (file->write( batch ) != batch.size()) || !syncToDisk( file ) )
+		{
+			// Data of this batch may not have made it, so write it again when next needed
+			journaled->keys.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+
+	///
+	/// Append framed entry to batch
+	///
+	void EditJournal::appendEntry( QByteArray& batch, EntryType type, const QByteArray& payload )
+	{
+		QDataStream out( &batch, QIODevice::WriteOnly | QIODevice::Append );
+		out.setVersion( journalStreamVersion );
+		out << quint32(payload.size()) << quint8(type);
+		out.writeRawData( payload.constData(), payload.size() );
+		out << qChecksum( payload.constData(), uint(payload.size()) );
+	}
+
+
+	///
+	/// Encode payload of object entry.  Embedded data not yet in the journal is
+	/// appended to batch first, so the entry itself only refers to it by key.
+	///
+	QByteArray EditJournal::encodeObjectEntry( const Entry& entry, JournaledData* journaled, QByteArray& batch )
+	{
+		QList<LabelModelObject*> objects;
+		objects << entry.object.data();
+
+		DataCache data( objects );
+
+		QStringList       names;
+		QStringList       mimetypes;
+		QList<QByteArray> keys;
+
+		foreach ( QString name, data.imageNames() )
+		{
+			QByteArray bytes = data.getImageData( name );
+			QByteArray key;
+
+			if ( !bytes.isEmpty() )
+			{
+				key = dataKey( bytes );
+			}
+			else
+			{
+				// Only encode a decoded image the first time we see it
+				QImage image = data.getImage( name );
+				key = journaled->imageKeys.value( image.cacheKey() );
+				if ( key.isEmpty() )
+				{
+					QBuffer buffer( &bytes );
+					buffer.open( QIODevice::WriteOnly );
+					image.save( &buffer, "PNG" );
+
+					key = dataKey( bytes );
+					journaled->imageKeys.insert( image.cacheKey(), key );
+				}
+			}
+
+			if ( !journaled->keys.contains( key ) )
+			{
+				QByteArray payload;
+				QDataStream out( &payload, QIODevice::WriteOnly );
+				out.setVersion( journalStreamVersion );
+				out << key << bytes;
+
+				appendEntry( batch, DataEntry, payload );
+				journaled->keys.insert( key );
+			}
+
+			names << name;
+			mimetypes << "image/png";
+			keys << key;
+		}
+
+		foreach ( QString name, data.svgNames() )
+		{
+			QByteArray svg = data.getSvg( name );
+			QByteArray key = dataKey( svg );
+
+			if ( !journaled->keys.contains( key ) )
+			{
+				QByteArray payload;
+				QDataStream out( &payload, QIODevice::WriteOnly );
+				out.setVersion( journalStreamVersion );
+				out << key << svg;
+
+				appendEntry( batch, DataEntry, payload );
+				journaled->keys.insert( key );
+			}
+
+			names << name;
+			mimetypes << "image/svg+xml";
+			keys << key;
+		}
+
+		QByteArray xml;
+		XmlLabelCreator::serializeObjects( objects, xml, false );
+
+		QByteArray payload;
+		QDataStream out( &payload, QIODevice::WriteOnly );
+		out.setVersion( journalStreamVersion );
+		out << qint32(entry.id) << qCompress( xml ) << names << mimetypes << keys;
+
+		return payload;
+	}
+
+
+	///
+	/// Encode payload of entry
+	///
+	QByteArray EditJournal::encodeEntry( const Entry& entry )
+	{
+		QByteArray payload;
+
+		QDataStream out( &payload, QIODevice::WriteOnly );
+		out.setVersion( journalStreamVersion );
+
+		switch ( entry.type )
+		{
+		case HeaderEntry:
+			out << entry.fileName;
+			break;
+
+		case FileBaseEntry:
+			out << entry.fileName << toStreamIds( entry.ids );
+			break;
+
+		case PropertiesEntry:
+		{
+			QByteArray xml;
+			XmlLabelCreator::writeBuffer( entry.properties.data(), xml );
+			out << qCompress( xml );
+			break;
+		}
+
+		case ObjectEntry:
+		case DataEntry:
+			// See encodeObjectEntry()
+			break;
+
+		case OrderEntry:
+			out << toStreamIds( entry.ids );
+			break;
+
+		case BaseEndEntry:
+			break;
+		}
+
+		return payload;
+	}
+
+} // namespace glabels
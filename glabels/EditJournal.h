@@ -0,0 +1,175 @@
+/*  EditJournal.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EditJournal_h
+#define EditJournal_h
+
+
+#include "LabelModel.h"
+
+#include <QFile>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QLockFile>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+
+namespace glabels
+{
+
+	// Forward references
+	class LabelModelObject;
+
+
+	///
+	/// Edit Journal
+	///
+	/// Append-only record of the edits made to a label since it was last saved,
+	/// used to recover the session after a crash.  The journal starts with a
+	/// base (a reference to the saved file, or a full copy of an unsaved label),
+	/// followed by entries for each changed object, object order and label
+	/// properties.  Embedded images are journaled once, keyed by a hash of their
+	/// contents, and object entries only refer to them.  Entries are captured as
+	/// cheap clones on the GUI thread, then serialized, appended and fsync'd in
+	/// batches on a worker thread.
+	///
+	class EditJournal : public QObject
+	{
+		Q_OBJECT
+
+
+		/////////////////////////////////
+		// Life Cycle
+		/////////////////////////////////
+	public:
+		EditJournal( LabelModel* model );
+		~EditJournal() override;
+
+
+		/////////////////////////////////
+		// Public methods
+		/////////////////////////////////
+	public:
+		void reset();
+		void discard();
+
+
+		/////////////////////////////////
+		// Recovery
+		/////////////////////////////////
+	public:
+		static QStringList orphanedJournals();
+		static LabelModel* replay( const QString& journalPath );
+		static void remove( const QString& journalPath );
+
+
+		/////////////////////////////////
+		// Private slots
+		/////////////////////////////////
+	private slots:
+		void onChanged();
+		void onTimeout();
+		void onWriteFinished();
+
+
+		/////////////////////////////////
+		// Private types
+		/////////////////////////////////
+	private:
+		enum EntryType
+		{
+			HeaderEntry     = 1,
+			FileBaseEntry   = 2,
+			PropertiesEntry = 3,
+			ObjectEntry     = 4,
+			OrderEntry      = 5,
+			BaseEndEntry    = 6,
+			DataEntry       = 7
+		};
+
+		struct Entry
+		{
+			Entry( EntryType type ) : type(type), id(0) {}
+
+			EntryType                         type;
+			QString                           fileName;
+			int                               id;
+			QList<int>                        ids;
+			QSharedPointer<LabelModelObject>  object;
+			QSharedPointer<LabelModel>        properties;
+		};
+
+		///
+		/// Embedded data already in the journal (only used by the write job)
+		///
+		struct JournaledData
+		{
+			QSet<QByteArray>          keys;
+			QHash<qint64,QByteArray>  imageKeys;  // of decoded images, by QImage::cacheKey()
+		};
+
+
+		/////////////////////////////////
+		// Private methods
+		/////////////////////////////////
+	private:
+		void record();
+		void recordProperties();
+		void recordObject( LabelModelObject* object );
+		void startWrite();
+
+		static bool writeEntries( QFile* file, JournaledData* journaled, const QList<Entry>& entries );
+		static void appendEntry( QByteArray& batch, EntryType type, const QByteArray& payload );
+		static QByteArray encodeEntry( const Entry& entry );
+		static QByteArray encodeObjectEntry( const Entry& entry, JournaledData* journaled, QByteArray& batch );
+
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		LabelModel*                 mModel;
+
+		QString                     mPath;
+		QFile                       mFile;
+		QLockFile*                  mLock;
+		bool                        mDiscarded;
+
+		QTimer                      mTimer;
+		LabelModel::Changes         mPendingChanges;
+		QHash<int,quint64>          mRevisions;
+		QList<int>                  mOrder;
+
+		QList<Entry>                mQueue;
+		QFutureWatcher<bool>        mWriteWatcher;
+		JournaledData               mJournaled;
+
+	};
+
+}
+
+
+#endif // EditJournal_h
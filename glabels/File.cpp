@@ -20,6 +20,8 @@
 
 #include "File.h"
 
+#include "AutoSaver.h"
+#include "EditJournal.h"
 #include "FileUtil.h"
 #include "LabelModel.h"
 #include "MainWindow.h"
@@ -27,6 +29,7 @@
 #include "XmlLabelParser.h"
 #include "XmlLabelCreator.h"
 
+#include <QFile>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QtDebug>
@@ -105,10 +108,9 @@ namespace glabels
 				);
 		if ( !fileName.isEmpty() )
 		{
-			LabelModel *label = XmlLabelParser::readFile( fileName );
+			LabelModel *label = readFileOrAutoSave( window, fileName );
 			if ( label )
 			{
-				label->setFileName( fileName );
 				
 				// Either apply to current window or open a new one
 				if ( window->isEmpty() )
@@ -137,6 +139,51 @@ namespace glabels
 	}
 
 
+	///
+	/// Read file, offering to recover its auto saved backup if that is newer
+	///
+	LabelModel* File::readFileOrAutoSave( MainWindow *window, const QString& fileName )
+	{
+		QString autoSavePath = AutoSaver::autoSavePath( fileName );
+
+		if ( AutoSaver::hasNewerAutoSave( fileName ) )
+		{
+			QString msg = tr("Recover auto saved changes to project \"%1\"?").arg( QFileInfo( fileName ).fileName() );
+			QString info = tr("An auto saved copy of this project is newer than the project itself.");
+
+			int ret = QMessageBox::warning( window,
+			                                tr( "Recover project?" ),
+			                                "<b>" + msg + "</b><p>" + info + "</p>",
+			                                (QMessageBox::Yes|QMessageBox::Discard),
+			                                QMessageBox::Yes );
+
+			if ( ret == QMessageBox::Yes )
+			{
+				LabelModel *label = XmlLabelParser::readFile( autoSavePath );
+				if ( label )
+				{
+					// Recovered changes are not in the file until it is saved
+					label->setFileName( fileName );
+					label->setModified();
+					return label;
+				}
+				qWarning() << "Unable to read auto saved copy" << autoSavePath;
+			}
+			else
+			{
+				QFile::remove( autoSavePath );
+			}
+		}
+
+		LabelModel *label = XmlLabelParser::readFile( fileName );
+		if ( label )
+		{
+			label->setFileName( fileName );
+		}
+		return label;
+	}
+
+
 	///
 	/// Save file
 	///
@@ -152,8 +199,16 @@ namespace glabels
 			return true;
 		}
 
-		XmlLabelCreator::writeFile( window->model(), window->model()->fileName() );
+		// Don't let a pending auto save land on top of this one
+		window->autoSaver()->waitForFinished();
+
+		if ( !XmlLabelCreator::writeFile( window->model(), window->model()->fileName() ) )
+		{
+			return false;
+		}
 		window->model()->clearModified();
+		window->editJournal()->reset();
+		window->autoSaver()->discard();
 
 		// Save CWD
 		mCwd = QFileInfo( window->model()->fileName() ).absolutePath();
@@ -206,9 +261,16 @@ namespace glabels
 				}
 			}
 			
-			XmlLabelCreator::writeFile( window->model(), fileName );
+			window->autoSaver()->waitForFinished();
+
+			if ( !XmlLabelCreator::writeFile( window->model(), fileName ) )
+			{
+				return false;
+			}
+			window->autoSaver()->discard();
 			window->model()->setFileName( fileName );
 			window->model()->clearModified();
+			window->editJournal()->reset();
 		
 			// Save CWD
 			mCwd = QFileInfo( fileName ).absolutePath();
@@ -229,6 +291,50 @@ namespace glabels
 	}
 
 
+	///
+	/// Offer to recover labels from journals of sessions that did not shut down cleanly
+	///
+	void File::recover( MainWindow *window )
+	{
+		foreach ( QString journalPath, EditJournal::orphanedJournals() )
+		{
+			LabelModel* label = EditJournal::replay( journalPath );
+			if ( label )
+			{
+				QString msg = tr("Recover unsaved changes to project \"%1\"?").arg( label->shortName() );
+				QString info = tr("gLabels was not shut down properly the last time this project was open.");
+
+				int ret = QMessageBox::warning( window,
+				                                tr( "Recover project?" ),
+				                                "<b>" + msg + "</b><p>" + info + "</p>",
+				                                (QMessageBox::Yes|QMessageBox::Discard),
+				                                QMessageBox::Yes );
+
+				if ( ret == QMessageBox::Yes )
+				{
+					// Either apply to current window or open a new one
+					if ( window->isEmpty() )
+					{
+						window->setModel( label );
+					}
+					else
+					{
+						MainWindow *newWindow = new MainWindow();
+						newWindow->setModel( label );
+						newWindow->show();
+					}
+				}
+				else
+				{
+					delete label;
+				}
+			}
+
+			EditJournal::remove( journalPath );
+		}
+	}
+
+
 	///
 	/// Exit, closing all windows
 	///
@@ -23,12 +23,14 @@
 
 
 #include <QObject>
+#include <QString>
 
 
 namespace glabels
 {
 
 	// Forward References
+	class LabelModel;
 	class MainWindow;
 
 
@@ -48,8 +50,11 @@ namespace glabels
 		static bool saveAs( MainWindow *window );
 		static void close( MainWindow *window );
 		static void exit();
+		static void recover( MainWindow *window );
 
 	private:
+		static LabelModel* readFileOrAutoSave( MainWindow *window, const QString& fileName );
+
 		static QString mCwd;
 	
 	};
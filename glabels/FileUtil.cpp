@@ -23,6 +23,8 @@
 #include "Config.h"
 
 #include <QApplication>
+#include <QStandardPaths>
+#include <QtDebug>
 
 
 namespace glabels
@@ -62,6 +64,19 @@ namespace glabels
 	}
 
 
+	QDir FileUtil::userTemplatesDir()
+	{
+		QDir dir( QStandardPaths::writableLocation( QStandardPaths::AppDataLocation ) );
+
+		if ( !dir.mkpath( "templates" ) || !dir.cd( "templates" ) )
+		{
+			qWarning() << "Cannot create user templates directory in" << dir.path();
+		}
+
+		return dir;
+	}
+
+
 	QDir FileUtil::translationsDir()
 	{
 		QDir dir;
@@ -84,4 +99,30 @@ namespace glabels
 		return QDir("/");
 	}
 
+
+	QDir FileUtil::journalDir()
+	{
+		QDir dir( QStandardPaths::writableLocation( QStandardPaths::AppDataLocation ) );
+
+		if ( !dir.mkpath( "journal" ) || !dir.cd( "journal" ) )
+		{
+			qWarning() << "Cannot create journal directory in" << dir.path();
+		}
+
+		return dir;
+	}
+
+
+	QDir FileUtil::cacheDir()
+	{
+		QDir dir( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) );
+
+		if ( !dir.mkpath( "." ) )
+		{
+			qWarning() << "Cannot create cache directory" << dir.path();
+		}
+
+		return dir;
+	}
+
 } // namespace glabels
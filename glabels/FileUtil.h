@@ -38,6 +38,10 @@ namespace glabels
 		QDir userTemplatesDir();
 
 		QDir translationsDir();
+
+		QDir journalDir();
+
+		QDir cacheDir();
 	}
 
 }
@@ -80,25 +80,9 @@ namespace glabels
 	}
 	
 
-	QVector<Point> Frame::getOrigins() const
+	const QVector<Point>& Frame::getOrigins() const
 	{
-		QVector<Point> origins( nLabels() );
-
-		int i = 0;
-		foreach ( Layout *layout, mLayouts )
-		{
-			for ( int iy = 0; iy < layout->ny(); iy++ )
-			{
-				for ( int ix = 0; ix < layout->nx(); ix++ )
-				{
-					origins[i++] = Point( ix*layout->dx() + layout->x0(), iy*layout->dy() + layout->y0() );
-				}
-			}
-		}
-
-		qStableSort( origins.begin(), origins.end() );
-
-		return origins;
+		return mOrigins;
 	}
 
 
@@ -109,6 +93,9 @@ namespace glabels
 		// Update total number of labels
 		mNLabels += layout->nx() * layout->ny();
 
+		// Frames are not modified once loaded, so origins are only computed here
+		updateOrigins();
+
 		// Update layout description
 		if ( mLayouts.size() == 1 )
 		{
@@ -133,4 +120,24 @@ namespace glabels
 		mMarkups << markup;
 	}
 
+
+	void Frame::updateOrigins()
+	{
+		mOrigins.resize( nLabels() );
+
+		int i = 0;
+		foreach ( Layout *layout, mLayouts )
+		{
+			for ( int iy = 0; iy < layout->ny(); iy++ )
+			{
+				for ( int ix = 0; ix < layout->nx(); ix++ )
+				{
+					mOrigins[i++] = Point( ix*layout->dx() + layout->x0(), iy*layout->dy() + layout->y0() );
+				}
+			}
+		}
+
+		qStableSort( mOrigins.begin(), mOrigins.end() );
+	}
+
 } // namespace glabels
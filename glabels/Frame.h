@@ -57,7 +57,7 @@ namespace glabels
 		const QList<Layout*>& layouts() const;
 		const QList<Markup*>& markups() const;
 
-		QVector<Point> getOrigins() const;
+		const QVector<Point>& getOrigins() const;
 
 		void addLayout( Layout* layout );
 		void addMarkup( Markup* markup );
@@ -73,6 +73,10 @@ namespace glabels
 		virtual QPainterPath marginPath( const Distance& size ) const = 0;
 
 
+	private:
+		void updateOrigins();
+
+
 	private:
 		QString mId;
 		int     mNLabels;
@@ -80,6 +84,8 @@ namespace glabels
 
 		QList<Layout*> mLayouts;
 		QList<Markup*> mMarkups;
+
+		QVector<Point> mOrigins;
 	};
 
 }
@@ -0,0 +1,253 @@
+/*  GzipDevice.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GzipDevice.h"
+
+#include <QtDebug>
+
+
+namespace glabels
+{
+
+	//
+	// Private
+	//
+	namespace
+	{
+		const int chunkSize = 64*1024;
+	}
+
+
+	///
+	/// Constructor
+	///
+	GzipDevice::GzipDevice( QIODevice* device, int compressionLevel )
+		: mDevice(device), mCompressionLevel(compressionLevel), mStreamOpen(false), mStreamEnd(false)
+	{
+		mStream.zalloc = Z_NULL;
+		mStream.zfree  = Z_NULL;
+		mStream.opaque = Z_NULL;
+	}
+
+
+	///
+	/// Destructor
+	///
+	GzipDevice::~GzipDevice()
+	{
+		close();
+	}
+
+
+	///
+	/// Open device, either ReadOnly (inflate) or WriteOnly (deflate)
+	///
+	bool GzipDevice::open( OpenMode mode )
+	{
+		OpenMode direction = mode & ReadWrite;
+		if ( (direction != ReadOnly) && (direction != WriteOnly) )
+		{
+			qWarning() << "GzipDevice: unsupported open mode" << mode;
+			return false;
+		}
+
+		if ( !mDevice->isOpen() && !mDevice->open( direction ) )
+		{
+			setErrorString( mDevice->errorString() );
+			return false;
+		}
+
+		mStream.next_in  = Z_NULL;
+		mStream.avail_in = 0;
+
+		int ret;
+		if ( direction == ReadOnly )
+		{
+			ret = inflateInit2( &mStream, MAX_WBITS + 16 ); // gzip decoding
+		}
+		else
+		{
+			ret = deflateInit2( &mStream, mCompressionLevel, Z_DEFLATED,
+			                    MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY ); // gzip encoding
+		}
+		if ( ret != Z_OK )
+		{
+			setErrorString( "Cannot initialize zlib stream" );
+			return false;
+		}
+		mStreamOpen = true;
+		mStreamEnd  = false;
+
+		return QIODevice::open( mode );
+	}
+
+
+	///
+	/// Close device, finishing the gzip stream if writing
+	///
+	void GzipDevice::close()
+	{
+		if ( mStreamOpen )
+		{
+			if ( openMode() & WriteOnly )
+			{
+				flushDeflate( Z_FINISH );
+				deflateEnd( &mStream );
+			}
+			else
+			{
+				inflateEnd( &mStream );
+			}
+			mStreamOpen = false;
+		}
+		mInBuffer.clear();
+
+		QIODevice::close();
+	}
+
+
+	///
+	/// Device is sequential
+	///
+	bool GzipDevice::isSequential() const
+	{
+		return true;
+	}
+
+
+	///
+	/// At end of stream?
+	///
+	bool GzipDevice::atEnd() const
+	{
+		return mStreamEnd && QIODevice::atEnd();
+	}
+
+
+	///
+	/// Inflate up to maxSize bytes
+	///
+	qint64 GzipDevice::readData( char* data, qint64 maxSize )
+	{
+		if ( mStreamEnd || !mStreamOpen )
+		{
+			return mStreamEnd ? 0 : -1;
+		}
+
+		uInt outSize = uInt( qMin( maxSize, qint64(chunkSize) ) );
+		mStream.next_out  = reinterpret_cast<Bytef*>( data );
+		mStream.avail_out = outSize;
+
+		// Return as soon as some data is available, so readers stay incremental
+		while ( mStream.avail_out == outSize )
+		{
+			if ( mStream.avail_in == 0 )
+			{
+				mInBuffer = mDevice->read( chunkSize );
+				if ( mInBuffer.isEmpty() )
+				{
+					qWarning( "GzipDevice: Input data is truncated" );
+					mStreamEnd = true;
+					break;
+				}
+				mStream.next_in  = reinterpret_cast<Bytef*>( mInBuffer.data() );
+				mStream.avail_in = uInt( mInBuffer.size() );
+			}
+
+			int ret = inflate( &mStream, Z_NO_FLUSH );
+			if ( ret == Z_STREAM_END )
+			{
+				mStreamEnd = true;
+				break;
+			}
+			if ( (ret == Z_NEED_DICT) || (ret == Z_DATA_ERROR) || (ret == Z_MEM_ERROR) )
+			{
+				setErrorString( "Corrupt gzip data" );
+				return -1;
+			}
+		}
+
+		return qint64( outSize - mStream.avail_out );
+	}
+
+
+	///
+	/// Deflate data into underlying device
+	///
+	qint64 GzipDevice::writeData( const char* data, qint64 maxSize )
+	{
+		if ( !mStreamOpen )
+		{
+			return -1;
+		}
+
+		qint64 nWritten = 0;
+		while ( nWritten < maxSize )
+		{
+			uInt inSize = uInt( qMin( maxSize - nWritten, qint64(chunkSize) ) );
+
+			mStream.next_in  = reinterpret_cast<Bytef*>( const_cast<char*>( data + nWritten ) );
+			mStream.avail_in = inSize;
+
+			if ( !flushDeflate( Z_NO_FLUSH ) )
+			{
+				return -1;
+			}
+
+			nWritten += inSize;
+		}
+
+		return nWritten;
+	}
+
+
+	///
+	/// Run deflate until all pending input is consumed, writing output to
+	/// underlying device.  With Z_FINISH, also terminates the gzip stream.
+	///
+	bool GzipDevice::flushDeflate( int flush )
+	{
+		char out[chunkSize];
+
+		int ret;
+		do
+		{
+			mStream.next_out  = reinterpret_cast<Bytef*>( out );
+			mStream.avail_out = chunkSize;
+
+			ret = deflate( &mStream, flush );
+			if ( ret == Z_STREAM_ERROR )
+			{
+				setErrorString( "Deflate failed" );
+				return false;
+			}
+
+			qint64 nOut = chunkSize - mStream.avail_out;
+			if ( (nOut > 0) && (mDevice->write( out, nOut ) != nOut) )
+			{
+				setErrorString( mDevice->errorString() );
+				return false;
+			}
+		} while ( (mStream.avail_out == 0) || ((flush == Z_FINISH) && (ret != Z_STREAM_END)) );
+
+		return true;
+	}
+
+} // namespace glabels
@@ -0,0 +1,91 @@
+/*  GzipDevice.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GzipDevice_h
+#define GzipDevice_h
+
+
+#include <QByteArray>
+#include <QIODevice>
+
+#include <zlib.h>
+
+
+namespace glabels
+{
+
+	///
+	/// Gzip Device
+	///
+	/// Sequential device that inflates a gzip stream read from an underlying
+	/// device on the fly (ReadOnly), or deflates data written to it into the
+	/// underlying device (WriteOnly), so that a compressed document never has
+	/// to be held in memory in both its compressed and uncompressed forms.
+	///
+	class GzipDevice : public QIODevice
+	{
+
+		/////////////////////////////////
+		// Life Cycle
+		/////////////////////////////////
+	public:
+		GzipDevice( QIODevice* device, int compressionLevel = Z_DEFAULT_COMPRESSION );
+		~GzipDevice() override;
+
+
+		/////////////////////////////////
+		// QIODevice implementation
+		/////////////////////////////////
+	public:
+		bool open( OpenMode mode ) override;
+		void close() override;
+		bool isSequential() const override;
+		bool atEnd() const override;
+
+	protected:
+		qint64 readData( char* data, qint64 maxSize ) override;
+		qint64 writeData( const char* data, qint64 maxSize ) override;
+
+
+		/////////////////////////////////
+		// Private methods
+		/////////////////////////////////
+	private:
+		bool flushDeflate( int flush );
+
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		QIODevice*  mDevice;
+		int         mCompressionLevel;
+
+		z_stream    mStream;
+		bool        mStreamOpen;
+		bool        mStreamEnd;
+		QByteArray  mInBuffer;
+
+	};
+
+}
+
+
+#endif // GzipDevice_h
@@ -73,6 +73,8 @@ namespace glabels
 		const QColor  selectRegionFillColor( 192, 192, 255, 128 );
 		const QColor  selectRegionOutlineColor( 0, 0, 255, 128 );
 		const double  selectRegionOutlineWidthPixels = 3;
+
+		const int     dirtyPadPixels = 8; // Room for outlines, handles and antialiasing
 	}
 
 
@@ -141,7 +143,8 @@ namespace glabels
 		{
 			zoomToFit();
 
-			connect( model, SIGNAL(changed()), this, SLOT(update()) );
+			connect( model, SIGNAL(objectBoundsChanged(const QRectF&,const QRectF&)),
+			         this, SLOT(onModelObjectBoundsChanged(const QRectF&,const QRectF&)) );
 			connect( model, SIGNAL(selectionChanged()), this, SLOT(update()) );
 			connect( model, SIGNAL(sizeChanged()), this, SLOT(onModelSizeChanged()) );
 
@@ -909,6 +912,23 @@ namespace glabels
 	}
 
 
+	///
+	/// Map a rectangle in label coordinates to a padded rectangle in device coordinates
+	///
+	QRect
+	LabelEditor::deviceRect( const QRectF& labelRect ) const
+	{
+		QTransform transform;
+
+		transform.scale( mScale, mScale );
+		transform.translate( mX0.pt(), mY0.pt() );
+
+		QRect r = transform.mapRect( labelRect ).toAlignedRect();
+
+		return r.adjusted( -dirtyPadPixels, -dirtyPadPixels, dirtyPadPixels, dirtyPadPixels );
+	}
+
+
 	///
 	/// Key Press Event Handler
 	void
@@ -985,9 +1005,9 @@ namespace glabels
 			drawBgLayer( &painter );
 			drawGridLayer( &painter );
 			drawMarkupLayer( &painter );
-			drawObjectsLayer( &painter );
+			drawObjectsLayer( &painter, event->region() );
 			drawFgLayer( &painter );
-			drawHighlightLayer( &painter );
+			drawHighlightLayer( &painter, event->region() );
 			drawSelectRegionLayer( &painter );
 		}
 	}
@@ -1126,9 +1146,15 @@ namespace glabels
 	/// Draw Objects Layer
 	///
 	void
-	LabelEditor::drawObjectsLayer( QPainter* painter )
+	LabelEditor::drawObjectsLayer( QPainter* painter, const QRegion& region )
 	{
-		mModel->draw( painter );
+		foreach ( LabelModelObject* object, mModel->objectList() )
+		{
+			if ( region.intersects( deviceRect( object->boundingRect() ) ) )
+			{
+				object->draw( painter, true, nullptr );
+			}
+		}
 	}
 
 
@@ -1163,13 +1189,13 @@ namespace glabels
 	/// Draw Highlight Layer
 	///
 	void
-	LabelEditor::drawHighlightLayer( QPainter* painter )
+	LabelEditor::drawHighlightLayer( QPainter* painter, const QRegion& region )
 	{
 		painter->save();
 
 		foreach ( LabelModelObject* object, mModel->objectList() )
 		{
-			if ( object->isSelected() )
+			if ( object->isSelected() && region.intersects( deviceRect( object->boundingRect() ) ) )
 			{
 				object->drawSelectionHighlight( painter, mScale );
 			}
@@ -1249,4 +1275,16 @@ namespace glabels
 		emit zoomChanged();
 	}
 
+
+	///
+	/// Model object bounds changed handler
+	///
+	void LabelEditor::onModelObjectBoundsChanged( const QRectF& oldBounds, const QRectF& newBounds )
+	{
+		QRegion region( deviceRect( oldBounds ) );
+		region += deviceRect( newBounds );
+
+		update( region );
+	}
+
 } // namespace glabels
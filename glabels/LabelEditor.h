@@ -25,6 +25,7 @@
 #include "Region.h"
 
 #include <QPainter>
+#include <QRegion>
 #include <QScrollArea>
 #include <QWidget>
 
@@ -135,12 +136,14 @@ namespace glabels
 		void handleResizeMotion( const Distance& xWorld,
 		                         const Distance& yWorld );
 
+		QRect deviceRect( const QRectF& labelRect ) const;
+
 		void drawBgLayer( QPainter* painter );
 		void drawGridLayer( QPainter* painter );
 		void drawMarkupLayer( QPainter* painter );
-		void drawObjectsLayer( QPainter* painter );
+		void drawObjectsLayer( QPainter* painter, const QRegion& region );
 		void drawFgLayer( QPainter* painter );
-		void drawHighlightLayer( QPainter* painter );
+		void drawHighlightLayer( QPainter* painter, const QRegion& region );
 		void drawSelectRegionLayer( QPainter* painter );
 
 
@@ -150,6 +153,7 @@ namespace glabels
 	private slots:
 		void onSettingsChanged();
 		void onModelSizeChanged();
+		void onModelObjectBoundsChanged( const QRectF& oldBounds, const QRectF& newBounds );
 
 
 		/////////////////////////////////////
@@ -20,6 +20,7 @@
 
 #include "LabelModel.h"
 
+#include "Db.h"
 #include "LabelModelObject.h"
 #include "LabelModelTextObject.h"
 #include "LabelModelImageObject.h"
@@ -34,6 +35,7 @@
 #include <QClipboard>
 #include <QFileInfo>
 #include <QMimeData>
+#include <QMutexLocker>
 #include <QtDebug>
 
 
@@ -46,18 +48,38 @@ namespace glabels
 	namespace
 	{
 		const QString MIME_TYPE = "application/x-glabels-objects";
+
+		const double  hitSlopPixels = 8; // Covers hover slop and handle size
+
+		// Number of models (undo, autosave and print snapshots included) using
+		// each template, so that Db knows when a replaced one can be deleted.
+		// Snapshots are created and destroyed on worker threads too.
+		QMutex                     templateUseMutex;
+		QHash<const Template*,int> templateUseCounts;
 	}
 
 
 	///
 	/// Default constructor.
 	///
-	LabelModel::LabelModel() : mUntitledInstance(0), mModified(true), mTmplate(nullptr), mRotate(false)
+	LabelModel::LabelModel()
+		: mUntitledInstance(0), mModified(true), mCompressionLevel(9), mTmplate(nullptr), mRotate(false),
+		  mZOrderValid(false), mBatchDepth(0), mPendingChanges(NoChanges), mPendingModifiedChanged(false),
+		  mLastChanges(NoChanges)
 	{
 		mMerge = new merge::None();
 	}
 
 
+	///
+	/// Destructor.
+	///
+	LabelModel::~LabelModel()
+	{
+		useTemplate( nullptr );
+	}
+
+
 	///
 	/// Save model state
 	///
@@ -70,10 +92,36 @@ namespace glabels
 	}
 
 
+	///
+	/// Save model properties only (no objects, default merge)
+	///
+	LabelModel* LabelModel::saveProperties() const
+	{
+		LabelModel* savedModel = new LabelModel;
+		savedModel->restore( this, QList<LabelModelObject*>(), nullptr );
+
+		return savedModel;
+	}
+
+
 	///
 	/// Restore model state
 	///
 	void LabelModel::restore( const LabelModel *savedModel )
+	{
+		restore( savedModel, savedModel->mObjectList, savedModel->mMerge );
+	}
+
+
+	///
+	/// Restore model state from separately saved properties, objects and merge
+	///
+	/// Saved objects and merge are cloned, not adopted.  If savedMerge is null,
+	/// the current merge is kept.
+	///
+	void LabelModel::restore( const LabelModel*               savedProperties,
+	                          const QList<LabelModelObject*>& savedObjects,
+	                          const merge::Merge*             savedMerge )
 	{
 		// Clear current object list
 		foreach ( LabelModelObject* object, mObjectList )
@@ -81,17 +129,19 @@ namespace glabels
 			delete object;
 		}
 		mObjectList.clear();
+		mObjectIndex.clear();
+		mZOrderValid = false;
 
 		// Now copy state
-		mUntitledInstance = savedModel->mUntitledInstance;
-		mModified         = savedModel->mModified;
-		mFileName         = savedModel->mFileName;
-		mCompressionLevel = savedModel->mCompressionLevel;
-		mTmplate          = savedModel->mTmplate;
-		mFrame            = savedModel->mFrame;
-		mRotate           = savedModel->mRotate;
+		mUntitledInstance = savedProperties->mUntitledInstance;
+		mModified         = savedProperties->mModified;
+		mFileName         = savedProperties->mFileName;
+		mCompressionLevel = savedProperties->mCompressionLevel;
+		useTemplate( savedProperties->mTmplate );
+		mFrame            = savedProperties->mFrame;
+		mRotate           = savedProperties->mRotate;
 
-		foreach ( LabelModelObject* savedObject, savedModel->mObjectList )
+		foreach ( LabelModelObject* savedObject, savedObjects )
 		{
 			LabelModelObject* object = savedObject->clone();
 		
@@ -100,13 +150,20 @@ namespace glabels
 
 			connect( object, SIGNAL(changed()), this, SLOT(onObjectChanged()) );
 			connect( object, SIGNAL(moved()), this, SLOT(onObjectMoved()) );
+			connect( object, SIGNAL(boundsChanged(const QRectF&,const QRectF&)),
+			         this, SLOT(onObjectBoundsChanged(const QRectF&,const QRectF&)) );
+
+			mObjectIndex.insert( object, object->boundingRect() );
 		}
 
-		delete mMerge;
-		mMerge = savedModel->mMerge->clone();
+		if ( savedMerge )
+		{
+			delete mMerge;
+			mMerge = savedMerge->clone();
+		}
 
 		// Emit signals based on potential changes
-		emit changed();
+		emitChanged( AllChanges );
 		emit selectionChanged();
 		emit modifiedChanged();
 		emit nameChanged();
@@ -191,12 +248,12 @@ namespace glabels
 	{
 		if (mTmplate != tmplate)
 		{
-			mTmplate = tmplate;
+			useTemplate( tmplate );
 			mFrame = tmplate->frames().first();
 
 			setModified();
 		
-			emit changed();
+			emitChanged( LabelChanged );
 			emit sizeChanged();
 
 			Settings::addToRecentTemplateList( tmplate->name() );
@@ -204,6 +261,51 @@ namespace glabels
 	}
 
 
+	///
+	/// Is template used by any model
+	///
+	bool LabelModel::isTemplateInUse( const Template* tmplate )
+	{
+		QMutexLocker locker( &templateUseMutex );
+		return templateUseCounts.contains( tmplate );
+	}
+
+
+	///
+	/// Set template, keeping count of its uses
+	///
+	void LabelModel::useTemplate( const Template* tmplate )
+	{
+		if ( tmplate == mTmplate )
+		{
+			return;
+		}
+
+		bool released = false;
+		{
+			QMutexLocker locker( &templateUseMutex );
+
+			if ( tmplate )
+			{
+				templateUseCounts[tmplate]++;
+			}
+			if ( mTmplate && (--templateUseCounts[mTmplate] == 0) )
+			{
+				templateUseCounts.remove( mTmplate );
+				released = true;
+			}
+		}
+
+		mTmplate = tmplate;
+
+		if ( released )
+		{
+			// Db may be waiting to delete it; may be called on a worker thread
+			QMetaObject::invokeMethod( Db::instance(), "purgeRetiredTemplates", Qt::QueuedConnection );
+		}
+	}
+
+
 	///
 	/// Get rotation
 	///
@@ -224,7 +326,7 @@ namespace glabels
 
 			setModified();
 
-			emit changed();
+			emitChanged( LabelChanged );
 			emit sizeChanged();
 		}
 	}
@@ -307,7 +409,7 @@ namespace glabels
 
 			setModified();
 		
-			emit changed();
+			emitChanged( MergeChanged );
 			emit mergeChanged();
 			emit mergeSourceChanged();
 		}
@@ -320,7 +422,15 @@ namespace glabels
 	void LabelModel::setModified()
 	{
 		mModified = true;
-		emit modifiedChanged();
+
+		if ( mBatchDepth > 0 )
+		{
+			mPendingModifiedChanged = true;
+		}
+		else
+		{
+			emit modifiedChanged();
+		}
 	}
 
 
@@ -334,6 +444,84 @@ namespace glabels
 	}
 
 
+	///
+	/// Begin batch of changes
+	///
+	/// Until the matching endBatch(), changed() and modifiedChanged() are not
+	/// emitted.  Instead, the kinds of changes are accumulated and reported by a
+	/// single changed() when the outermost batch ends.  Batches may be nested.
+	///
+	void LabelModel::beginBatch()
+	{
+		mBatchDepth++;
+	}
+
+
+	///
+	/// End batch of changes
+	///
+	void LabelModel::endBatch()
+	{
+		if ( mBatchDepth == 0 )
+		{
+			qWarning() << "LabelModel::endBatch: no matching beginBatch().";
+			return;
+		}
+
+		if ( --mBatchDepth == 0 )
+		{
+			if ( mPendingModifiedChanged )
+			{
+				mPendingModifiedChanged = false;
+				emit modifiedChanged();
+			}
+
+			if ( mPendingChanges )
+			{
+				Changes changes = mPendingChanges;
+				mPendingChanges = NoChanges;
+
+				emitChanged( changes );
+			}
+		}
+	}
+
+
+	///
+	/// Is a batch of changes in progress?
+	///
+	bool LabelModel::isBatching() const
+	{
+		return mBatchDepth > 0;
+	}
+
+
+	///
+	/// Summary of changes reported by the most recent changed() signal
+	///
+	LabelModel::Changes LabelModel::lastChanges() const
+	{
+		return mLastChanges;
+	}
+
+
+	///
+	/// Emit changed(), or defer it if a batch is in progress
+	///
+	void LabelModel::emitChanged( Changes changes )
+	{
+		if ( mBatchDepth > 0 )
+		{
+			mPendingChanges |= changes;
+		}
+		else
+		{
+			mLastChanges = changes;
+			emit changed();
+		}
+	}
+
+
 	///
 	/// Add object.
 	///
@@ -341,13 +529,22 @@ namespace glabels
 	{
 		object->setParent( this );
 		mObjectList << object;
+		if ( mZOrderValid )
+		{
+			mZOrder.insert( object, mObjectList.size() - 1 );
+		}
 
 		connect( object, SIGNAL(changed()), this, SLOT(onObjectChanged()) );
 		connect( object, SIGNAL(moved()), this, SLOT(onObjectMoved()) );
+		connect( object, SIGNAL(boundsChanged(const QRectF&,const QRectF&)),
+		         this, SLOT(onObjectBoundsChanged(const QRectF&,const QRectF&)) );
 
 		setModified();
 
-		emit changed();
+		QRectF bounds = object->boundingRect();
+		mObjectIndex.insert( object, bounds );
+		emit objectBoundsChanged( bounds, bounds );
+		emitChanged( ObjectsAdded );
 	}
 
 
@@ -358,12 +555,16 @@ namespace glabels
 	{
 		object->unselect();
 		mObjectList.removeOne( object );
+		mObjectIndex.remove( object );
+		mZOrderValid = false;
 
 		disconnect( object, nullptr, this, nullptr );
 
 		setModified();
 
-		emit changed();
+		QRectF bounds = object->boundingRect();
+		emit objectBoundsChanged( bounds, bounds );
+		emitChanged( ObjectsRemoved );
 
 		delete object;
 	}
@@ -376,19 +577,24 @@ namespace glabels
 	                                        const Distance& x,
 	                                        const Distance& y ) const
 	{
-		/* Search object list in reverse order.  I.e. from top to bottom. */
-		QList<LabelModelObject*>::const_iterator it = mObjectList.end();
-		while ( it != mObjectList.begin() )
+		/* Only objects whose bounds are near x,y need a precise test. */
+		double tol = hitSlopPixels / scale;
+		QRectF probe( x.pt() - tol, y.pt() - tol, 2*tol, 2*tol );
+
+		/* Of those located at x,y, pick the top-most, i.e. the last in the object list. */
+		LabelModelObject* topObject = nullptr;
+		int               topIndex  = -1;
+		foreach ( LabelModelObject* object, mObjectIndex.query( probe ) )
 		{
-			it--;
-			LabelModelObject* object = *it;
-			if ( object->isLocatedAt( scale, x, y ) )
+			int index = zOrder( object );
+			if ( (index > topIndex) && object->isLocatedAt( scale, x, y ) )
 			{
-				return object;
+				topObject = object;
+				topIndex  = index;
 			}
 		}
 
-		return nullptr;
+		return topObject;
 	}
 
 
@@ -399,16 +605,51 @@ namespace glabels
 	                              const Distance& x,
 	                              const Distance& y ) const
 	{
-		foreach( LabelModelObject* object, mObjectList )
+		double tol = hitSlopPixels / scale;
+		QRectF probe( x.pt() - tol, y.pt() - tol, 2*tol, 2*tol );
+
+		/* Preserve original precedence: the first object in the list with a handle at x,y. */
+		Handle* firstHandle = nullptr;
+		int     firstIndex  = mObjectList.size();
+		foreach ( LabelModelObject* object, mObjectIndex.query( probe ) )
 		{
-			Handle* handle = object->handleAt( scale, x, y );
-			if ( handle )
+			if ( !object->isSelected() )
 			{
-				return handle;
+				continue;
+			}
+
+			int index = zOrder( object );
+			if ( index < firstIndex )
+			{
+				Handle* handle = object->handleAt( scale, x, y );
+				if ( handle )
+				{
+					firstHandle = handle;
+					firstIndex  = index;
+				}
 			}
 		}
 
-		return nullptr;
+		return firstHandle;
+	}
+
+
+	///
+	/// Position of object in object list (i.e. z-order), without a linear search
+	///
+	int LabelModel::zOrder( const LabelModelObject* object ) const
+	{
+		if ( !mZOrderValid )
+		{
+			mZOrder.clear();
+			for ( int i = 0; i < mObjectList.size(); i++ )
+			{
+				mZOrder.insert( mObjectList[i], i );
+			}
+			mZOrderValid = true;
+		}
+
+		return mZOrder.value( object, -1 );
 	}
 
 
@@ -418,7 +659,7 @@ namespace glabels
 	void LabelModel::onObjectChanged()
 	{
 		setModified();
-		emit changed();
+		emitChanged( ObjectsChanged );
 	}
 
 
@@ -428,7 +669,22 @@ namespace glabels
 	void LabelModel::onObjectMoved()
 	{
 		setModified();
-		emit changed();
+		emitChanged( ObjectsMoved );
+	}
+
+
+	///
+	/// Object Bounds Changed Slot
+	///
+	void LabelModel::onObjectBoundsChanged( const QRectF& oldBounds, const QRectF& newBounds )
+	{
+		LabelModelObject* object = qobject_cast<LabelModelObject*>( sender() );
+		if ( object )
+		{
+			mObjectIndex.update( object, newBounds );
+		}
+
+		emit objectBoundsChanged( oldBounds, newBounds );
 	}
 
 
@@ -438,7 +694,7 @@ namespace glabels
 	void LabelModel::onMergeSourceChanged()
 	{
 		setModified();
-		emit changed();
+		emitChanged( MergeChanged );
 		emit mergeSourceChanged();
 	}
 
@@ -448,7 +704,7 @@ namespace glabels
 	///
 	void LabelModel::onMergeSelectionChanged()
 	{
-		emit changed();
+		emitChanged( MergeChanged );
 		emit mergeSelectionChanged();
 	}
 
@@ -513,7 +769,9 @@ namespace glabels
 		Distance rX2 = max( region.x1(), region.x2() );
 		Distance rY2 = max( region.y1(), region.y2() );
 
-		foreach ( LabelModelObject* object, mObjectList )
+		QRectF r( rX1.pt(), rY1.pt(), (rX2-rX1).pt(), (rY2-rY1).pt() );
+
+		foreach ( LabelModelObject* object, mObjectIndex.query( r ) )
 		{
 			Region objectExtent = object->getExtent();
 
@@ -679,6 +937,8 @@ namespace glabels
 	///
 	void LabelModel::deleteSelection()
 	{
+		beginBatch();
+
 		QList<LabelModelObject*> selectedList = getSelection();
 
 		foreach ( LabelModelObject* object, selectedList )
@@ -688,8 +948,10 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsRemoved );
 		emit selectionChanged();
+
+		endBatch();
 	}
 
 
@@ -705,15 +967,20 @@ namespace glabels
 			mObjectList.removeOne( object );
 		}
 
+		mZOrderValid = false;
+
 		// Move to end of list, representing top most object.
 		foreach ( LabelModelObject* object, selectedList )
 		{
 			mObjectList.push_back( object );
+
+			QRectF bounds = object->boundingRect();
+			emit objectBoundsChanged( bounds, bounds );
 		}
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsReordered );
 	}
 
 
@@ -729,15 +996,20 @@ namespace glabels
 			mObjectList.removeOne( object );
 		}
 
+		mZOrderValid = false;
+
 		// Move to front of list, representing bottom most object.
 		foreach ( LabelModelObject* object, selectedList )
 		{
 			mObjectList.push_front( object );
+
+			QRectF bounds = object->boundingRect();
+			emit objectBoundsChanged( bounds, bounds );
 		}
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsReordered );
 	}
 
 
@@ -746,6 +1018,8 @@ namespace glabels
 	///
 	void LabelModel::rotateSelection( double thetaDegs )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -756,7 +1030,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -783,6 +1059,8 @@ namespace glabels
 	///
 	void LabelModel::flipSelectionHoriz()
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -793,7 +1071,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -802,6 +1082,8 @@ namespace glabels
 	///
 	void LabelModel::flipSelectionVert()
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -812,7 +1094,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -826,6 +1110,8 @@ namespace glabels
 			return;
 		}
 
+		beginBatch();
+
 		QList<LabelModelObject*> selectedList = getSelection();
 
 		// Find left-most edge.
@@ -846,7 +1132,9 @@ namespace glabels
 		
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsMoved );
+
+		endBatch();
 	}
 
 
@@ -860,6 +1148,8 @@ namespace glabels
 			return;
 		}
 
+		beginBatch();
+
 		QList<LabelModelObject*> selectedList = getSelection();
 
 		// Find right-most edge.
@@ -880,7 +1170,9 @@ namespace glabels
 		
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsMoved );
+
+		endBatch();
 	}
 
 
@@ -894,6 +1186,8 @@ namespace glabels
 			return;
 		}
 
+		beginBatch();
+
 		QList<LabelModelObject*> selectedList = getSelection();
 
 		// Find average center of objects.
@@ -931,7 +1225,9 @@ namespace glabels
 		
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsMoved );
+
+		endBatch();
 	}
 
 
@@ -945,6 +1241,8 @@ namespace glabels
 			return;
 		}
 
+		beginBatch();
+
 		QList<LabelModelObject*> selectedList = getSelection();
 
 		// Find top-most edge.
@@ -965,7 +1263,9 @@ namespace glabels
 		
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsMoved );
+
+		endBatch();
 	}
 
 
@@ -979,6 +1279,8 @@ namespace glabels
 			return;
 		}
 
+		beginBatch();
+
 		QList<LabelModelObject*> selectedList = getSelection();
 
 		// Find bottom-most edge.
@@ -999,7 +1301,9 @@ namespace glabels
 		
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsMoved );
+
+		endBatch();
 	}
 
 
@@ -1013,6 +1317,8 @@ namespace glabels
 			return;
 		}
 
+		beginBatch();
+
 		QList<LabelModelObject*> selectedList = getSelection();
 
 		// Find average center of objects.
@@ -1050,7 +1356,9 @@ namespace glabels
 		
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsMoved );
+
+		endBatch();
 	}
 
 
@@ -1059,6 +1367,8 @@ namespace glabels
 	///
 	void LabelModel::centerSelectionHoriz()
 	{
+		beginBatch();
+
 		Distance xLabelCenter = w() / 2.0;
 
 		foreach ( LabelModelObject* object, mObjectList )
@@ -1074,7 +1384,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsMoved );
+
+		endBatch();
 	}
 
 
@@ -1083,6 +1395,8 @@ namespace glabels
 	///
 	void LabelModel::centerSelectionVert()
 	{
+		beginBatch();
+
 		Distance yLabelCenter = h() / 2.0;
 
 		foreach ( LabelModelObject* object, mObjectList )
@@ -1098,7 +1412,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsMoved );
+
+		endBatch();
 	}
 
 
@@ -1107,6 +1423,8 @@ namespace glabels
 	///
 	void LabelModel::moveSelection( const Distance& dx, const Distance& dy )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1117,7 +1435,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsMoved );
+
+		endBatch();
 	}
 
 
@@ -1126,6 +1446,8 @@ namespace glabels
 	///
 	void LabelModel::setSelectionFontFamily( const QString &fontFamily )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1136,7 +1458,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -1145,6 +1469,8 @@ namespace glabels
 	///
 	void LabelModel::setSelectionFontSize( double fontSize )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1155,7 +1481,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -1164,6 +1492,8 @@ namespace glabels
 	///
 	void LabelModel::setSelectionFontWeight( QFont::Weight fontWeight )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1174,7 +1504,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -1183,6 +1515,8 @@ namespace glabels
 	///
 	void LabelModel::setSelectionFontItalicFlag( bool fontItalicFlag )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1193,7 +1527,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -1202,6 +1538,8 @@ namespace glabels
 	///
 	void LabelModel::setSelectionTextHAlign( Qt::Alignment textHAlign )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1212,7 +1550,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -1221,6 +1561,8 @@ namespace glabels
 	///
 	void LabelModel::setSelectionTextVAlign( Qt::Alignment textVAlign )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1231,7 +1573,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -1240,6 +1584,8 @@ namespace glabels
 	///
 	void LabelModel::setSelectionTextLineSpacing( double textLineSpacing )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1250,7 +1596,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -1259,6 +1607,8 @@ namespace glabels
 	///
 	void LabelModel::setSelectionTextColorNode( ColorNode textColorNode )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1269,7 +1619,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -1278,6 +1630,8 @@ namespace glabels
 	///
 	void LabelModel::setSelectionLineWidth( const Distance& lineWidth )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1288,7 +1642,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -1297,6 +1653,8 @@ namespace glabels
 	///
 	void LabelModel::setSelectionLineColorNode( ColorNode lineColorNode )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1307,7 +1665,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -1316,6 +1676,8 @@ namespace glabels
 	///
 	void LabelModel::setSelectionFillColorNode( ColorNode fillColorNode )
 	{
+		beginBatch();
+
 		foreach ( LabelModelObject* object, mObjectList )
 		{
 			if ( object->isSelected() )
@@ -1326,7 +1688,9 @@ namespace glabels
 
 		setModified();
 
-		emit changed();
+		emitChanged( ObjectsChanged );
+
+		endBatch();
 	}
 
 
@@ -1392,6 +1756,8 @@ namespace glabels
 		const QClipboard *clipboard = QApplication::clipboard();
 		const QMimeData *mimeData = clipboard->mimeData();
 
+		beginBatch();
+
 		if ( mimeData->hasFormat( MIME_TYPE ) )
 		{
 			// Native objects
@@ -1427,6 +1793,8 @@ namespace glabels
 			unselectAll();
 			selectObject( object );
 		}
+
+		endBatch();
 	}
 
 
@@ -23,11 +23,13 @@
 
 
 #include "Settings.h"
+#include "SpatialIndex.h"
 #include "Template.h"
 
 #include "Merge/Merge.h"
 #include "Merge/Record.h"
 
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QPainter>
@@ -55,14 +57,37 @@ namespace glabels
 		/////////////////////////////////
 	public:
 		LabelModel();
-		~LabelModel() override {}
+		~LabelModel() override;
 
 	
+		/////////////////////////////////
+		// Change summary flags
+		/////////////////////////////////
+	public:
+		enum ChangeFlag
+		{
+			NoChanges        = 0x00,
+			ObjectsChanged   = 0x01,
+			ObjectsMoved     = 0x02,
+			ObjectsAdded     = 0x04,
+			ObjectsRemoved   = 0x08,
+			ObjectsReordered = 0x10,
+			LabelChanged     = 0x20,
+			MergeChanged     = 0x40,
+			AllChanges       = 0x7F
+		};
+		Q_DECLARE_FLAGS( Changes, ChangeFlag )
+
+
 		/////////////////////////////////
 		// Save/restore model state
 		/////////////////////////////////
 		LabelModel* save() const;
+		LabelModel* saveProperties() const;
 		void restore( const LabelModel *savedModel );
+		void restore( const LabelModel*               savedProperties,
+		              const QList<LabelModelObject*>& savedObjects,
+		              const merge::Merge*             savedMerge );
 	
 
 		/////////////////////////////////
@@ -70,6 +95,7 @@ namespace glabels
 		/////////////////////////////////
 	signals:
 		void changed();
+		void objectBoundsChanged( const QRectF& oldBounds, const QRectF& newBounds );
 		void nameChanged();
 		void sizeChanged();
 		void selectionChanged();
@@ -98,6 +124,11 @@ namespace glabels
 		const Frame* frame() const;
 		void setTmplate( const Template* tmplate );
 
+		static bool isTemplateInUse( const Template* tmplate );
+	private:
+		void useTemplate( const Template* tmplate );
+	public:
+
 		bool rotate() const;
 		void setRotate( bool rotate );
 
@@ -110,6 +141,18 @@ namespace glabels
 		void setMerge( merge::Merge* merge );
 	
 		
+		/////////////////////////////////
+		// Batch changes
+		/////////////////////////////////
+	public:
+		void beginBatch();
+		void endBatch();
+		bool isBatching() const;
+		Changes lastChanges() const;
+	private:
+		void emitChanged( Changes changes );
+
+
 		/////////////////////////////////
 		// Manage objects
 		/////////////////////////////////
@@ -124,6 +167,9 @@ namespace glabels
 		Handle* handleAt( double          scale,
 		                  const Distance& x,
 		                  const Distance& y ) const;
+	private:
+		int zOrder( const LabelModelObject* object ) const;
+	public:
 
 
 		/////////////////////////////////
@@ -212,6 +258,7 @@ namespace glabels
 	private slots:
 		void onObjectChanged();
 		void onObjectMoved();
+		void onObjectBoundsChanged( const QRectF& oldBounds, const QRectF& newBounds );
 		void onMergeSourceChanged();
 		void onMergeSelectionChanged();
 
@@ -229,11 +276,24 @@ namespace glabels
 		bool                      mRotate;
 
 		QList<LabelModelObject*>  mObjectList;
+		SpatialIndex              mObjectIndex;
+
+		// Position of each object in mObjectList, rebuilt when invalidated
+		mutable QHash<const LabelModelObject*,int> mZOrder;
+		mutable bool              mZOrderValid;
 
 		merge::Merge*             mMerge;
+
+		int                       mBatchDepth;
+		Changes                   mPendingChanges;
+		bool                      mPendingModifiedChanged;
+		Changes                   mLastChanges;
 	};
 
 }
 
 
+Q_DECLARE_OPERATORS_FOR_FLAGS( glabels::LabelModel::Changes )
+
+
 #endif // LabelModel_h
@@ -23,9 +23,12 @@
 #include "Size.h"
 
 #include <QBrush>
+#include <QBuffer>
 #include <QFileInfo>
 #include <QImage>
+#include <QImageReader>
 #include <QPen>
+#include <QtConcurrent>
 #include <QtDebug>
 
 
@@ -41,7 +44,8 @@ namespace glabels
 	///
 	/// Constructor
 	///
-	LabelModelImageObject::LabelModelImageObject() : mImage(nullptr), mSvgRenderer(nullptr)
+	LabelModelImageObject::LabelModelImageObject()
+		: mImage(nullptr), mSvgRenderer(nullptr), mDecodeWatcher(nullptr)
 	{
 		mOutline = new Outline( this );
 
@@ -64,7 +68,8 @@ namespace glabels
 	///
 	/// Copy constructor
 	///
-	LabelModelImageObject::LabelModelImageObject( const LabelModelImageObject* object ) : LabelModelObject(object)
+	LabelModelImageObject::LabelModelImageObject( const LabelModelImageObject* object )
+		: LabelModelObject(object), mDecodeWatcher(nullptr)
 	{
 		mFilenameNode = object->mFilenameNode;
 		if ( object->mImage )
@@ -75,6 +80,8 @@ namespace glabels
 		{
 			mImage = nullptr;
 		}
+		mEmbeddedImage = object->mEmbeddedImage;
+		mImageSize = object->mImageSize;
 		if ( object->mSvgRenderer )
 		{
 			mSvgRenderer = new QSvgRenderer( object->mSvg );
@@ -108,6 +115,9 @@ namespace glabels
 		{
 			delete mSvgRenderer;
 		}
+
+		// A decode in progress holds on to its own reference to the image
+		delete mDecodeWatcher;
 	}
 
 
@@ -149,6 +159,12 @@ namespace glabels
 	///
 	const QImage* LabelModelImageObject::image() const
 	{
+		if ( mEmbeddedImage )
+		{
+			// First use of embedded image, decode it now (or wait for the pool)
+			return mEmbeddedImage->image();
+		}
+
 		return mImage;
 	}
 
@@ -171,6 +187,9 @@ namespace glabels
 				mSvgRenderer = nullptr;
 			}
 
+			mEmbeddedImage.clear();
+			mImageSize = QSize();
+
 			mImage = new QImage(value);
 			quint16 cs = qChecksum( (const char*)mImage->constBits(), mImage->byteCount() );
 			mFilenameNode = TextNode( false, QString("%image_%1%").arg( cs ) );
@@ -198,12 +217,68 @@ namespace glabels
 				mSvgRenderer = nullptr;
 			}
 
+			mEmbeddedImage.clear();
+			mImageSize = QSize();
+
 			mImage = new QImage(value);
 			mFilenameNode = TextNode( false, name );
 
 			emit changed();
 		}
 	}
+
+
+	///
+	/// Image imageData Property Getter
+	///
+	QByteArray LabelModelImageObject::imageData() const
+	{
+		return mEmbeddedImage ? mEmbeddedImage->data() : QByteArray();
+	}
+
+
+	///
+	/// Image imageData Property Setter
+	///
+	/// Only the image header is read here (for naturalSize()); the pixels are
+	/// not decoded until the image is first needed.
+	///
+	void LabelModelImageObject::setImageData( const QString& name, const QByteArray& value )
+	{
+		if ( !value.isEmpty() )
+		{
+			if ( mImage )
+			{
+				delete mImage;
+				mImage = nullptr;
+			}
+			if ( mSvgRenderer )
+			{
+				delete mSvgRenderer;
+				mSvgRenderer = nullptr;
+			}
+
+			mEmbeddedImage = QSharedPointer<EmbeddedImage>( new EmbeddedImage( value ) );
+
+			QBuffer buffer;
+			buffer.setData( value );
+			buffer.open( QIODevice::ReadOnly );
+			mImageSize = QImageReader( &buffer ).size();
+
+			mFilenameNode = TextNode( false, name );
+
+			emit changed();
+		}
+	}
+
+
+	///
+	/// Has image been decoded?
+	///
+	bool LabelModelImageObject::isImageDecoded() const
+	{
+		return (mImage != nullptr) || (mEmbeddedImage && mEmbeddedImage->isDecoded());
+	}
 		
 
 	///
@@ -233,6 +308,9 @@ namespace glabels
 				mSvgRenderer = nullptr;
 			}
 
+			mEmbeddedImage.clear();
+			mImageSize = QSize();
+
 			mSvg = value;
 			mSvgRenderer = new QSvgRenderer( mSvg );
 			mFilenameNode = TextNode( false, name );
@@ -255,6 +333,12 @@ namespace glabels
 			size.setW( Distance::pt( qsize.width() ) );
 			size.setH( Distance::pt( qsize.height() ) );
 		}
+		else if ( mImageSize.isValid() )
+		{
+			// Known from image header, no need to decode
+			size.setW( Distance::pt( mImageSize.width() ) );
+			size.setH( Distance::pt( mImageSize.height() ) );
+		}
 		else if ( mSvgRenderer )
 		{
 			QSize qsize = mSvgRenderer->defaultSize();
@@ -276,15 +360,17 @@ namespace glabels
 		QColor shadowColor = mShadowColorNode.color( record );
 		shadowColor.setAlphaF( mShadowOpacity );
 
-		if ( mImage && mImage->hasAlphaChannel() && (mImage->depth() == 32) )
+		const QImage* image = inEditor ? editorImage() : this->image();
+
+		if ( image && image->hasAlphaChannel() && (image->depth() == 32) )
 		{
-			QImage* shadowImage = createShadowImage( shadowColor );
+			QImage* shadowImage = createShadowImage( *image, shadowColor );
 			painter->drawImage( destRect, *shadowImage );
 			delete shadowImage;
 		}
 		else
 		{
-			if ( mImage || inEditor )
+			if ( image || inEditor )
 			{
 				painter->setBrush( shadowColor );
 				painter->setPen( QPen( Qt::NoPen ) );
@@ -301,17 +387,19 @@ namespace glabels
 	void LabelModelImageObject::drawObject( QPainter* painter, bool inEditor, merge::Record* record ) const
 	{
 		QRectF destRect( 0, 0, mW.pt(), mH.pt() );
+
+		const QImage* image = inEditor ? editorImage() : this->image();
 	
-		if ( inEditor && (mFilenameNode.isField() || (!mImage && !mSvgRenderer) ) )
+		if ( inEditor && (mFilenameNode.isField() || (!image && !mSvgRenderer) ) )
 		{
 			painter->save();
 			painter->setRenderHint( QPainter::SmoothPixmapTransform, false );
 			painter->drawImage( destRect, *smDefaultImage );
 			painter->restore();
 		}
-		else if ( mImage )
+		else if ( image )
 		{
-			painter->drawImage( destRect, *mImage );
+			painter->drawImage( destRect, *image );
 		}
 		else if ( mSvgRenderer )
 		{
@@ -341,6 +429,9 @@ namespace glabels
 	///
 	void LabelModelImageObject::loadImage()
 	{
+		mEmbeddedImage.clear();
+		mImageSize = QSize();
+
 		if ( mImage )
 		{
 			delete mImage;
@@ -415,17 +506,54 @@ namespace glabels
 	}
 
 
+	///
+	/// Image to draw in the editor.  An embedded image that has not been decoded
+	/// yet is decoded on the thread pool and drawn once it is done; until then
+	/// nullptr is returned.
+	///
+	const QImage* LabelModelImageObject::editorImage() const
+	{
+		if ( !mEmbeddedImage || mEmbeddedImage->isDecoded() )
+		{
+			return image();
+		}
+
+		if ( mDecodeWatcher == nullptr )
+		{
+			mDecodeWatcher = new QFutureWatcher<void>();
+			connect( mDecodeWatcher, SIGNAL(finished()), this, SLOT(onImageDecoded()) );
+			mDecodeWatcher->setFuture( EmbeddedImage::decodeLater( mEmbeddedImage ) );
+		}
+
+		return nullptr;
+	}
+
+
+	///
+	/// Image decoded handler
+	///
+	void LabelModelImageObject::onImageDecoded()
+	{
+		mDecodeWatcher->deleteLater();
+		mDecodeWatcher = nullptr;
+
+		// Not a change of the object itself, just have it repainted
+		QRectF bounds = boundingRect();
+		emit boundsChanged( bounds, bounds );
+	}
+
+
 	///
 	/// Create shadow image
 	///
-	QImage* LabelModelImageObject::createShadowImage( const QColor& color ) const
+	QImage* LabelModelImageObject::createShadowImage( const QImage& image, const QColor& color ) const
 	{
 		int r = color.red();
 		int g = color.green();
 		int b = color.blue();
 		int a = color.alpha();
 		
-		QImage* shadow = new QImage( *mImage );
+		QImage* shadow = new QImage( image );
 		for ( int iy = 0; iy < shadow->height(); iy++ )
 		{
 			QRgb* scanLine = (QRgb*)shadow->scanLine( iy );
@@ -439,4 +567,79 @@ namespace glabels
 		return shadow;
 	}
 
+
+	///
+	/// Embedded image constructor
+	///
+	LabelModelImageObject::EmbeddedImage::EmbeddedImage( const QByteArray& data )
+		: mData(data), mDecoded(0)
+	{
+		// empty
+	}
+
+
+	///
+	/// Encoded image data
+	///
+	const QByteArray& LabelModelImageObject::EmbeddedImage::data() const
+	{
+		return mData;
+	}
+
+
+	///
+	/// Has image been decoded?
+	///
+	bool LabelModelImageObject::EmbeddedImage::isDecoded() const
+	{
+		return mDecoded.loadAcquire() != 0;
+	}
+
+
+	///
+	/// Get decoded image, decoding it now or waiting for a decode in progress
+	///
+	const QImage* LabelModelImageObject::EmbeddedImage::image()
+	{
+		if ( !isDecoded() )
+		{
+			QMutexLocker locker( &mMutex );
+			if ( !isDecoded() )
+			{
+				if ( !mImage.loadFromData( mData ) )
+				{
+					qWarning() << "Unable to decode embedded image";
+				}
+				mDecoded.storeRelease( 1 );
+			}
+		}
+
+		return &mImage;
+	}
+
+
+	///
+	/// Start decoding image on the thread pool, unless already started (GUI thread only)
+	///
+	QFuture<void> LabelModelImageObject::EmbeddedImage::decodeLater( QSharedPointer<EmbeddedImage> embeddedImage )
+	{
+		// A default constructed future counts as canceled
+		if ( embeddedImage->mFuture.isCanceled() )
+		{
+			// Job holds its own reference, in case all objects sharing it are deleted
+			embeddedImage->mFuture = QtConcurrent::run( &EmbeddedImage::decode, embeddedImage );
+		}
+
+		return embeddedImage->mFuture;
+	}
+
+
+	///
+	/// Decode image (runs in worker thread)
+	///
+	void LabelModelImageObject::EmbeddedImage::decode( QSharedPointer<EmbeddedImage> embeddedImage )
+	{
+		embeddedImage->image();
+	}
+
 } // namespace glabels
@@ -24,6 +24,10 @@
 
 #include "LabelModelObject.h"
 
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QSharedPointer>
 #include <QSvgRenderer>
 
 
@@ -69,6 +73,14 @@ namespace glabels
 		void setImage( const QImage& value ) override;
 		void setImage( const QString& name, const QImage& value ) override;
 
+		//
+		// Image Property: imageData (encoded image, decoded on first use; in the
+		// editor on the thread pool, other callers of image() wait for it)
+		//
+		QByteArray imageData() const;
+		void setImageData( const QString& name, const QByteArray& value );
+		bool isImageDecoded() const;
+
 		//
 		// Image Property: svg
 		//
@@ -99,7 +111,45 @@ namespace glabels
 		// Private
 		///////////////////////////////////////////////////////////////
 		void loadImage();
-		QImage* createShadowImage( const QColor& color ) const;
+		const QImage* editorImage() const;
+		QImage* createShadowImage( const QImage& image, const QColor& color ) const;
+
+
+		///////////////////////////////////////////////////////////////
+		// Private slots
+		///////////////////////////////////////////////////////////////
+	private slots:
+		void onImageDecoded();
+
+
+		///////////////////////////////////////////////////////////////
+		// Private types
+		///////////////////////////////////////////////////////////////
+	protected:
+		///
+		/// Embedded image, shared by an object and its clones so that the
+		/// encoded data is decoded only once, whichever of them needs it first
+		///
+		class EmbeddedImage
+		{
+		public:
+			EmbeddedImage( const QByteArray& data );
+
+			const QByteArray& data() const;
+			bool isDecoded() const;
+			const QImage* image();
+
+			static QFuture<void> decodeLater( QSharedPointer<EmbeddedImage> embeddedImage );
+
+		private:
+			static void decode( QSharedPointer<EmbeddedImage> embeddedImage );
+
+			QByteArray     mData;
+			QMutex         mMutex;
+			QImage         mImage;
+			QAtomicInt     mDecoded;
+			QFuture<void>  mFuture;
+		};
 	
 
 		///////////////////////////////////////////////////////////////
@@ -108,9 +158,13 @@ namespace glabels
 	protected:
 		TextNode       mFilenameNode;
 		QImage*        mImage;
+		QSharedPointer<EmbeddedImage> mEmbeddedImage;
+		QSize          mImageSize;
 		QSvgRenderer*  mSvgRenderer;
 		QByteArray     mSvg;
 
+		mutable QFutureWatcher<void>* mDecodeWatcher;
+
 		static QImage* smDefaultImage;
 
 	};
@@ -39,12 +39,19 @@ namespace glabels
 	int LabelModelObject::msNextId = 0;
 
 
+	///
+	/// Next Object Revision
+	///
+	quint64 LabelModelObject::msNextRevision = 0;
+
+
 	///
 	/// Constructor
 	///
 	LabelModelObject::LabelModelObject() : QObject(nullptr)
 	{
 		mId = msNextId++;
+		mRevision = msNextRevision++;
 
 		mX0 = 0;
 		mY0 = 0;
@@ -61,6 +68,14 @@ namespace glabels
 		mSelectedFlag = false;
 
 		mOutline = nullptr;
+
+		mBoundsValid = false;
+
+		mHitCacheValid = false;
+		mHitCacheScale = 0;
+
+		connect( this, SIGNAL(changed()), this, SLOT(onChanged()) );
+		connect( this, SIGNAL(moved()), this, SLOT(onGeometryChanged()) );
 	}
 
 
@@ -69,7 +84,8 @@ namespace glabels
 	///
 	LabelModelObject::LabelModelObject( const LabelModelObject* object )
 	{
-		mId = msNextId++;
+		mId = object->mId;
+		mRevision = msNextRevision++;
 
 		mSelectedFlag    = object->mSelectedFlag;
 
@@ -99,6 +115,15 @@ namespace glabels
 		}
 
 		mMatrix          = object->mMatrix;
+
+		mBoundsValid     = object->mBoundsValid;
+		mBounds          = object->mBounds;
+
+		mHitCacheValid   = false;
+		mHitCacheScale   = 0;
+
+		connect( this, SIGNAL(changed()), this, SLOT(onChanged()) );
+		connect( this, SIGNAL(moved()), this, SLOT(onGeometryChanged()) );
 	}
 
 
@@ -120,6 +145,24 @@ namespace glabels
 	}
 
 
+	///
+	/// ID Property Setter (for an object recreated from its serialization)
+	///
+	void LabelModelObject::setId( int value )
+	{
+		mId = value;
+	}
+
+
+	///
+	/// Revision Property Getter
+	///
+	quint64 LabelModelObject::revision() const
+	{
+		return mRevision;
+	}
+
+
 	///
 	/// Selected Property Getter
 	///
@@ -1023,6 +1066,30 @@ namespace glabels
 	}
 
 
+	///
+	/// Get Bounding Rectangle of Everything Drawn for Object
+	///
+	/// Unlike getExtent(), this includes the shadow and anything drawn outside of
+	/// the nominal w x h box (e.g. overflowing text), so that it can be used to
+	/// determine which part of a view must be repainted when the object changes.
+	///
+	QRectF LabelModelObject::boundingRect() const
+	{
+		QRectF r = QRectF( 0, 0, mW.pt(), mH.pt() ).normalized();
+		r = r.united( hoverPath( 1.0 ).boundingRect() );
+		r.adjust( -lineWidth().pt()/2, -lineWidth().pt()/2, lineWidth().pt()/2, lineWidth().pt()/2 );
+
+		r = mMatrix.mapRect( r ).translated( mX0.pt(), mY0.pt() );
+
+		if ( mShadowState )
+		{
+			r = r.united( r.translated( mShadowX.pt(), mShadowY.pt() ) );
+		}
+
+		return r;
+	}
+
+
 	///
 	/// Rotate Object
 	///
@@ -1072,21 +1139,23 @@ namespace glabels
 	                                    const Distance& x,
 	                                    const Distance& y ) const
 	{
+		updateHitCache( scale );
+
 		QPointF p( x.pt(), y.pt() );
 
 		/*
 		 * Change point to object relative coordinates
 		 */
 		p -= QPointF( mX0.pt(), mY0.pt() ); // Translate point to x0,y0
-		p = mMatrix.inverted().map( p );
+		p = mInverseMatrix.map( p );
 
-		if ( hoverPath( scale ).contains( p ) )
+		if ( mHoverPathCache.contains( p ) )
 		{
 			return true;
 		}
 		else if ( isSelected() && mOutline )
 		{
-			if ( mOutline->hoverPath( scale ).contains( p ) )
+			if ( mOutlineHoverPathCache.contains( p ) )
 			{
 				return true;
 			}
@@ -1105,15 +1174,16 @@ namespace glabels
 	{
 		if ( mSelectedFlag )
 		{
+			updateHitCache( scale );
+
 			QPointF p( x.pt(), y.pt() );
 			p -= QPointF( mX0.pt(), mY0.pt() ); // Translate point to x0,y0
 
-			foreach ( Handle* handle, mHandles )
+			for ( int i = 0; i < mHandles.size(); i++ )
 			{
-				QPainterPath handlePath = mMatrix.map( handle->path( scale ) );
-				if ( handlePath.contains( p ) )
+				if ( mHandlePathsCache[i].contains( p ) )
 				{
-					return handle;
+					return mHandles[i];
 				}
 			}
 		}
@@ -1122,6 +1192,32 @@ namespace glabels
 	}
 
 
+	///
+	/// Rebuild hit-test cache for scale, if needed
+	///
+	void LabelModelObject::updateHitCache( double scale ) const
+	{
+		if ( mHitCacheValid && (mHitCacheScale == scale) )
+		{
+			return;
+		}
+
+		mInverseMatrix = mMatrix.inverted();
+
+		mHoverPathCache = hoverPath( scale );
+		mOutlineHoverPathCache = mOutline ? mOutline->hoverPath( scale ) : QPainterPath();
+
+		mHandlePathsCache.clear();
+		foreach ( Handle* handle, mHandles )
+		{
+			mHandlePathsCache.append( mMatrix.map( handle->path( scale ) ) );
+		}
+
+		mHitCacheScale = scale;
+		mHitCacheValid = true;
+	}
+
+
 	///
 	/// Draw object + shadow
 	///
@@ -1178,4 +1274,33 @@ namespace glabels
 		// empty
 	}
 
+
+	///
+	/// Changed handler
+	///
+	void LabelModelObject::onChanged()
+	{
+		// Size, shape or transformation may have changed, so cached paths are stale.
+		mHitCacheValid = false;
+
+		onGeometryChanged();
+	}
+
+
+	///
+	/// Geometry changed handler (object has been changed or moved)
+	///
+	void LabelModelObject::onGeometryChanged()
+	{
+		mRevision = msNextRevision++;
+
+		QRectF newBounds = boundingRect();
+		QRectF oldBounds = mBoundsValid ? mBounds : newBounds;
+
+		mBounds      = newBounds;
+		mBoundsValid = true;
+
+		emit boundsChanged( oldBounds, newBounds );
+	}
+
 } // namespace glabels
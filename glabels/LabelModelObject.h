@@ -35,6 +35,7 @@
 #include <QFont>
 #include <QMatrix>
 #include <QPainter>
+#include <QRectF>
 
 
 namespace glabels
@@ -74,6 +75,7 @@ namespace glabels
 	signals:
 		void moved();
 		void changed();
+		void boundsChanged( const QRectF& oldBounds, const QRectF& newBounds );
 
 
 		///////////////////////////////////////////////////////////////
@@ -81,9 +83,15 @@ namespace glabels
 		///////////////////////////////////////////////////////////////
 	public:
 		//
-		// ID Property.
+		// ID Property (shared by clones, so it survives undo/redo)
 		//
 		int id() const;
+		void setId( int value );
+
+		//
+		// Revision Property (changes whenever object state changes, but not on selection)
+		//
+		quint64 revision() const;
 
 		//
 		// Selected Property.
@@ -363,6 +371,7 @@ namespace glabels
 		void setWHonorAspect( const Distance& w );
 		void setHHonorAspect( const Distance& h );
 		Region getExtent();
+		QRectF boundingRect() const;
 		void rotate( double thetaDegs );
 		void flipHoriz();
 		void flipVert();
@@ -384,6 +393,17 @@ namespace glabels
 
 		virtual void sizeUpdated();
 
+	private:
+		void updateHitCache( double scale ) const;
+
+
+		///////////////////////////////////////////////////////////////
+		// Private slots
+		///////////////////////////////////////////////////////////////
+	private slots:
+		void onChanged();
+		void onGeometryChanged();
+
 		
 		///////////////////////////////////////////////////////////////
 		// Protected Members
@@ -410,11 +430,25 @@ namespace glabels
 		// Private Members
 		///////////////////////////////////////////////////////////////
 	private:
-		static int msNextId;
-		int        mId;
+		static int     msNextId;
+		int            mId;
+
+		static quint64 msNextRevision;
+		quint64        mRevision;
 
 		QMatrix    mMatrix;
 
+		bool       mBoundsValid;
+		QRectF     mBounds;
+
+		// Hit-test cache, valid for a single scale until the object next changes
+		mutable bool                mHitCacheValid;
+		mutable double              mHitCacheScale;
+		mutable QMatrix             mInverseMatrix;
+		mutable QPainterPath        mHoverPathCache;
+		mutable QPainterPath        mOutlineHoverPathCache;
+		mutable QList<QPainterPath> mHandlePathsCache;
+
 	};
 
 }
@@ -21,6 +21,8 @@
 #include "MainWindow.h"
 
 #include "Db.h"
+#include "AutoSaver.h"
+#include "EditJournal.h"
 #include "File.h"
 #include "Help.h"
 #include "Icons.h"
@@ -49,7 +51,7 @@ namespace glabels
 	/// Constructor
 	///
 	MainWindow::MainWindow()
-		: mModel(nullptr)
+		: mModel(nullptr), mEditJournal(nullptr), mAutoSaver(nullptr)
 	{
 		setWindowIcon( Icons::Glabels() );
 
@@ -144,7 +146,9 @@ namespace glabels
 	///
 	MainWindow::~MainWindow()
 	{
-		// empty
+		// Auto saver first, it waits for a save still in flight
+		delete mAutoSaver;
+		delete mEditJournal;
 	}
 
 
@@ -164,6 +168,8 @@ namespace glabels
 	{
 		mModel = label;
 		mUndoRedoModel = new UndoRedoModel( mModel );
+		mEditJournal = new EditJournal( mModel );
+		mAutoSaver = new AutoSaver( mModel );
 	
 		mPropertiesView->setModel( mModel, mUndoRedoModel );
 		mLabelEditor->setModel( mModel, mUndoRedoModel );
@@ -189,6 +195,24 @@ namespace glabels
 	}
 
 
+	///
+	/// Get edit journal accessor
+	///
+	EditJournal* MainWindow::editJournal() const
+	{
+		return mEditJournal;
+	}
+
+
+	///
+	/// Get auto saver accessor
+	///
+	AutoSaver* MainWindow::autoSaver() const
+	{
+		return mAutoSaver;
+	}
+
+
 	///
 	/// Is window empty?
 	///
@@ -206,6 +230,17 @@ namespace glabels
 		if ( isOkToClose() )
 		{
 			writeSettings();
+
+			// Closed cleanly, nothing to recover
+			if ( mAutoSaver )
+			{
+				mAutoSaver->discard();
+			}
+			if ( mEditJournal )
+			{
+				mEditJournal->discard();
+			}
+
 			event->accept();
 		}
 		else
@@ -1138,6 +1173,10 @@ namespace glabels
 	void MainWindow::editPreferences()
 	{
 		PreferencesDialog dialog( this );
+		if ( mModel )
+		{
+			dialog.setUndoMemoryUsage( mUndoRedoModel->memoryUsage() );
+		}
 		dialog.exec();
 	}
 
@@ -38,6 +38,8 @@ namespace glabels
 {
 
 	// Forward References
+	class AutoSaver;
+	class EditJournal;
 	class LabelEditor;
 	class LabelModel;
 	class MergeView;
@@ -70,6 +72,8 @@ namespace glabels
 	public:
 		LabelModel* model() const;
 		void setModel( LabelModel* label );
+		EditJournal* editJournal() const;
+		AutoSaver* autoSaver() const;
 		bool isEmpty() const;
 
 
@@ -211,6 +215,8 @@ namespace glabels
 
 		LabelModel*          mModel;
 		UndoRedoModel*       mUndoRedoModel;
+		EditJournal*         mEditJournal;
+		AutoSaver*           mAutoSaver;
 
 		QListWidget*         mContents;
 		QListWidgetItem*     mWelcomeButton;
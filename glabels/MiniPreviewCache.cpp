@@ -0,0 +1,212 @@
+/*  MiniPreviewCache.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MiniPreviewCache.h"
+
+#include "Db.h"
+#include "FileUtil.h"
+#include "MiniPreviewImage.h"
+#include "Template.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QSet>
+#include <QtConcurrent>
+#include <QtDebug>
+
+
+namespace glabels
+{
+
+	//
+	// Private
+	//
+	namespace
+	{
+		// Bump whenever MiniPreviewImage changes how previews look
+		const quint32 renderVersion = 1;
+
+		const int maxMemoryCost = 16*1024*1024; // bytes
+
+
+		int imageCost( const QImage& image )
+		{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+			return int( image.sizeInBytes() );
+#else
+			return image.byteCount();
+#endif
+		}
+	}
+
+
+	///
+	/// Constructor
+	///
+	MiniPreviewCache::MiniPreviewCache()
+	{
+		mDir = FileUtil::cacheDir();
+		if ( !mDir.mkpath( "previews" ) || !mDir.cd( "previews" ) )
+		{
+			qWarning() << "Cannot create preview cache directory in" << mDir.path();
+		}
+
+		mImages.setMaxCost( maxMemoryCost );
+
+		connect( Db::instance(), SIGNAL(changed()), this, SLOT(onDbChanged()) );
+	}
+
+
+	///
+	/// Get singleton instance
+	///
+	MiniPreviewCache* MiniPreviewCache::instance()
+	{
+		static MiniPreviewCache* cache = new MiniPreviewCache();
+		return cache;
+	}
+
+
+	///
+	/// Get preview of template, scheduling it for rendering if needed
+	///
+	QImage MiniPreviewCache::preview( const Template* tmplate )
+	{
+		QByteArray key = mKeys.value( tmplate );
+		if ( key.isEmpty() )
+		{
+			key = geometryKey( tmplate );
+			mKeys.insert( tmplate, key );
+		}
+
+		if ( QImage* image = mImages.object( key ) )
+		{
+			return *image;
+		}
+
+		if ( !mPending.contains( key ) )
+		{
+			QString fileName = mDir.absoluteFilePath( QString( key ) + ".png" );
+			// Rendered from a copy, Db may delete the template in the meantime
+			QtConcurrent::run( &MiniPreviewCache::render, this, *tmplate, key, fileName );
+		}
+		if ( !mPending[key].contains( tmplate ) )
+		{
+			mPending[key] << tmplate;
+		}
+
+		return QImage();
+	}
+
+
+	///
+	/// Rendered (or loaded) preview is available
+	///
+	void MiniPreviewCache::onRendered( const QByteArray& key, const QImage& image )
+	{
+		mImages.insert( key, new QImage( image ), imageCost( image ) );
+
+		foreach ( const Template* tmplate, mPending.take( key ) )
+		{
+			emit previewReady( tmplate, image );
+		}
+	}
+
+
+	///
+	/// Templates have been replaced or removed, forget their pointers
+	///
+	void MiniPreviewCache::onDbChanged()
+	{
+		QSet<const Template*> current;
+		foreach ( const Template* tmplate, Db::templates() )
+		{
+			current << tmplate;
+		}
+
+		// Keys are cheap to recompute, but a deleted template's address may be reused
+		mKeys.clear();
+
+		for ( auto it = mPending.begin(); it != mPending.end(); ++it )
+		{
+			QList<const Template*> stillKnown;
+			foreach ( const Template* tmplate, it.value() )
+			{
+				if ( current.contains( tmplate ) )
+				{
+					stillKnown << tmplate;
+				}
+			}
+			it.value() = stillKnown;
+		}
+	}
+
+
+	///
+	/// Hash of everything that affects how a template's preview looks
+	///
+	QByteArray MiniPreviewCache::geometryKey( const Template* tmplate )
+	{
+		QByteArray geometry;
+		QDataStream out( &geometry, QIODevice::WriteOnly );
+		out.setVersion( QDataStream::Qt_5_4 );
+
+		out << renderVersion << qint32( TEMPLATE_PREVIEW_SIZE )
+		    << tmplate->pageWidth().pt() << tmplate->pageHeight().pt();
+
+		if ( !tmplate->frames().isEmpty() )
+		{
+			const Frame* frame = tmplate->frames().first();
+			out << frame->path();
+
+			foreach ( Layout* layout, frame->layouts() )
+			{
+				out << qint32( layout->nx() ) << qint32( layout->ny() )
+				    << layout->x0().pt() << layout->y0().pt()
+				    << layout->dx().pt() << layout->dy().pt();
+			}
+		}
+
+		return QCryptographicHash::hash( geometry, QCryptographicHash::Sha1 ).toHex();
+	}
+
+
+	///
+	/// Load preview from disk cache, or render and store it (runs in worker thread)
+	///
+	void MiniPreviewCache::render( MiniPreviewCache* cache, const Template& tmplate,
+	                               const QByteArray& key, const QString& fileName )
+	{
+		QImage image( fileName );
+		if ( image.isNull() )
+		{
+			image = MiniPreviewImage( &tmplate, TEMPLATE_PREVIEW_SIZE, TEMPLATE_PREVIEW_SIZE );
+
+			if ( !image.save( fileName, "PNG" ) )
+			{
+				qWarning() << "Cannot write preview cache file" << fileName;
+			}
+		}
+
+		QMetaObject::invokeMethod( cache, "onRendered", Qt::QueuedConnection,
+		                           Q_ARG( QByteArray, key ), Q_ARG( QImage, image ) );
+	}
+
+} // namespace glabels
@@ -0,0 +1,113 @@
+/*  MiniPreviewCache.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MiniPreviewCache_h
+#define MiniPreviewCache_h
+
+
+#include <QByteArray>
+#include <QCache>
+#include <QDir>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QObject>
+
+
+namespace glabels
+{
+
+	// Forward references
+	class Template;
+
+
+	///
+	/// Mini Preview Cache
+	///
+	/// Template previews are rendered on demand on the global thread pool and
+	/// kept in memory and in a thumbnail directory on disk.  Both are keyed
+	/// by a hash of the template's page and label geometry, so the many
+	/// templates that share a layout also share a single preview.
+	///
+	class MiniPreviewCache : public QObject
+	{
+		Q_OBJECT
+
+
+		/////////////////////////////////
+		// Life Cycle
+		/////////////////////////////////
+	private:
+		MiniPreviewCache();
+
+	public:
+		static MiniPreviewCache* instance();
+
+
+		/////////////////////////////////
+		// Signals
+		/////////////////////////////////
+	signals:
+		void previewReady( const Template* tmplate, const QImage& image );
+
+
+		/////////////////////////////////
+		// Public methods
+		/////////////////////////////////
+	public:
+		///
+		/// Get preview of template.  If not yet available, a null image is
+		/// returned and previewReady() is emitted once it has been rendered.
+		///
+		QImage preview( const Template* tmplate );
+
+
+		/////////////////////////////////
+		// Private slots
+		/////////////////////////////////
+	private slots:
+		void onRendered( const QByteArray& key, const QImage& image );
+		void onDbChanged();
+
+
+		/////////////////////////////////
+		// Private methods
+		/////////////////////////////////
+	private:
+		static QByteArray geometryKey( const Template* tmplate );
+		static void render( MiniPreviewCache* cache, const Template& tmplate,
+		                    const QByteArray& key, const QString& fileName );
+
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		QDir                                     mDir;
+		QHash<const Template*,QByteArray>        mKeys;
+		QCache<QByteArray,QImage>                mImages;
+		QHash<QByteArray,QList<const Template*>> mPending;
+
+	};
+
+}
+
+
+#endif // MiniPreviewCache_h
@@ -1,4 +1,4 @@
-/*  MiniPreviewPixmap.cpp
+/*  MiniPreviewImage.cpp
  *
  *  Copyright (C) 2013-2016  Jim Evins <evins@snaught.com>
  *
@@ -18,7 +18,7 @@
  *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "MiniPreviewPixmap.h"
+#include "MiniPreviewImage.h"
 
 #include "Template.h"
 
@@ -41,20 +41,20 @@ namespace glabels
 	}
 
 
-	MiniPreviewPixmap::MiniPreviewPixmap()
+	MiniPreviewImage::MiniPreviewImage()
 	{
 		// empty
 	}
 
 
-	MiniPreviewPixmap::MiniPreviewPixmap( const Template* tmplate, int width, int height )
-		: QPixmap( width, height )
+	MiniPreviewImage::MiniPreviewImage( const Template* tmplate, int width, int height )
+		: QImage( width, height, QImage::Format_ARGB32_Premultiplied )
 	{
 		draw( tmplate, width, height );
 	}
 
 
-	void MiniPreviewPixmap::draw( const Template* tmplate, int width, int height )
+	void MiniPreviewImage::draw( const Template* tmplate, int width, int height )
 	{
 		fill( Qt::transparent );
 
@@ -85,7 +85,7 @@ namespace glabels
 	}
 
 
-	void MiniPreviewPixmap::drawPaper( QPainter& painter, const Template* tmplate, double scale )
+	void MiniPreviewImage::drawPaper( QPainter& painter, const Template* tmplate, double scale )
 	{
 		QBrush brush( paperColor );
 		QPen pen( paperOutlineColor );
@@ -101,7 +101,7 @@ namespace glabels
 	}
 
 
-	void MiniPreviewPixmap::drawLabelOutlines( QPainter& painter, const Template* tmplate, double scale )
+	void MiniPreviewImage::drawLabelOutlines( QPainter& painter, const Template* tmplate, double scale )
 	{
 		QBrush brush( labelColor );
 		QPen pen( labelOutlineColor );
@@ -124,7 +124,7 @@ namespace glabels
 	}
 
 
-	void MiniPreviewPixmap::drawLabelOutline( QPainter& painter, const Frame* frame, const Point& p0 )
+	void MiniPreviewImage::drawLabelOutline( QPainter& painter, const Frame* frame, const Point& p0 )
 	{
 		painter.save();
 
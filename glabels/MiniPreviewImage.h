@@ -1,4 +1,4 @@
-/*  MiniPreviewPixmap.h
+/*  MiniPreviewImage.h
  *
  *  Copyright (C) 2013-2016  Jim Evins <evins@snaught.com>
  *
@@ -18,13 +18,13 @@
  *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#ifndef glabels_MiniPreviewPixmap_h
-#define glabels_MiniPreviewPixmap_h
+#ifndef glabels_MiniPreviewImage_h
+#define glabels_MiniPreviewImage_h
 
 
 #include "Point.h"
 
-#include <QPixmap>
+#include <QImage>
 #include <QPainter>
 
 
@@ -36,13 +36,19 @@ namespace glabels
 	class Frame;
 
 
-	class MiniPreviewPixmap : public QPixmap
+	///
+	/// Mini Preview Image
+	///
+	/// Drawn into a QImage rather than a QPixmap so that previews can be
+	/// rendered off the GUI thread.
+	///
+	class MiniPreviewImage : public QImage
 	{
 		
 	public:
-		MiniPreviewPixmap();
+		MiniPreviewImage();
 
-		MiniPreviewPixmap( const Template* tmplate, int width, int height );
+		MiniPreviewImage( const Template* tmplate, int width, int height );
 
 		
 	private:
@@ -56,4 +62,4 @@ namespace glabels
 }
 
 
-#endif // glabels_MiniPreviewPixmap_h
+#endif // glabels_MiniPreviewImage_h
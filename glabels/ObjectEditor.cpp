@@ -483,9 +483,11 @@ namespace glabels
 			mBlocked = true;
 
 			mUndoRedoModel->checkpoint( tr("Line") );
-		
+
+			mModel->beginBatch();
 			mObject->setLineWidth( Distance::pt(lineWidthSpin->value()) );
 			mObject->setLineColorNode( lineColorButton->colorNode() );
+			mModel->endBatch();
 
 			mBlocked = false;
 		}
@@ -636,7 +638,8 @@ namespace glabels
 			mBlocked = true;
 
 			mUndoRedoModel->checkpoint( tr("Text") );
-		
+
+			mModel->beginBatch();
 			mObject->setFontFamily( textFontFamilyCombo->currentText() );
 			mObject->setFontSize( textFontSizeSpin->value() );
 			mObject->setFontWeight( textFontBoldToggle->isChecked() ? QFont::Bold : QFont::Normal );
@@ -647,6 +650,7 @@ namespace glabels
 			mObject->setTextVAlign( Qt::AlignmentFlag( textVAlignGroup->checkedId() ) );
 			mObject->setTextLineSpacing( textLineSpacingSpin->value() );
 			mObject->setText( textEdit->toPlainText() );
+			mModel->endBatch();
 
 			mBlocked = false;
 		}
@@ -672,12 +676,14 @@ namespace glabels
 			mBlocked = true;
 
 			mUndoRedoModel->checkpoint( tr("Shadow") );
-		
+
+			mModel->beginBatch();
 			mObject->setShadow( shadowEnableCheck->isChecked() );
 			mObject->setShadowX( Distance(shadowXSpin->value(), mUnits) );
 			mObject->setShadowY( Distance(shadowYSpin->value(), mUnits) );
 			mObject->setShadowColorNode( shadowColorButton->colorNode() );
 			mObject->setShadowOpacity( shadowOpacitySpin->value()/100.0 );
+			mModel->endBatch();
 
 			mBlocked = false;
 		}
@@ -0,0 +1,243 @@
+/*  PageImageCache.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PageImageCache.h"
+
+#include "PageRenderer.h"
+
+#include <QPainter>
+#include <QtConcurrent>
+#include <QtDebug>
+
+
+namespace glabels
+{
+
+	//
+	// Private
+	//
+	namespace
+	{
+		const int maxMemoryCost = 64*1024*1024; // bytes
+
+
+		int imageCost( const QImage& image )
+		{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+			return int( image.sizeInBytes() );
+#else
+			return image.byteCount();
+#endif
+		}
+	}
+
+
+	///
+	/// Constructor
+	///
+	PageImageCache::PageImageCache( int maxPending, QObject* parent )
+		: QObject(parent), mRenderer(nullptr), mBackground(Qt::transparent), mMaxPending(maxPending)
+	{
+		mImages.setMaxCost( maxMemoryCost );
+
+		connect( &mRenderWatcher, SIGNAL(finished()), this, SLOT(onRenderFinished()) );
+	}
+
+
+	///
+	/// Destructor
+	///
+	PageImageCache::~PageImageCache()
+	{
+		mRenderWatcher.waitForFinished();
+	}
+
+
+	///
+	/// Set renderer
+	///
+	void PageImageCache::setRenderer( const PageRenderer* renderer )
+	{
+		if ( mRenderer )
+		{
+			disconnect( mRenderer, SIGNAL(changed()), this, SLOT(onRendererChanged()) );
+		}
+
+		mRenderer = renderer;
+
+		connect( mRenderer, SIGNAL(changed()), this, SLOT(onRendererChanged()) );
+		onRendererChanged();
+	}
+
+
+	///
+	/// Set background of rendered pages (transparent by default)
+	///
+	void PageImageCache::setBackground( const QColor& color )
+	{
+		if ( color != mBackground )
+		{
+			mBackground = color;
+			mImages.clear();
+		}
+	}
+
+
+	///
+	/// Get image of page, scheduling it for rendering if needed
+	///
+	QImage PageImageCache::image( int iPage, const QSize& size )
+	{
+		if ( (mRenderer == nullptr) || size.isEmpty() )
+		{
+			return QImage();
+		}
+
+		QString key = imageKey( iPage, size );
+
+		if ( QImage* image = mImages.object( key ) )
+		{
+			return *image;
+		}
+
+		if ( mRenderWatcher.isRunning() && (mRendering.key == key) )
+		{
+			return QImage();
+		}
+
+		// Most recent request first, dropping the oldest ones
+		for ( int i = 0; i < mPending.size(); i++ )
+		{
+			if ( mPending[i].key == key )
+			{
+				mPending.removeAt( i );
+				break;
+			}
+		}
+
+		Request request;
+		request.iPage = iPage;
+		request.size  = size;
+		request.key   = key;
+		mPending.prepend( request );
+
+		while ( mPending.size() > mMaxPending )
+		{
+			mPending.removeLast();
+		}
+
+		renderNext();
+
+		return QImage();
+	}
+
+
+	///
+	/// Renderer changed handler
+	///
+	void PageImageCache::onRendererChanged()
+	{
+		QString settingsKey = mRenderer->settingsKey();
+
+		if ( settingsKey != mSettingsKey )
+		{
+			// Pending requests and the snapshot are stale; cached images
+			// are keyed by the old settings, so they are simply not found.
+			mSettingsKey = settingsKey;
+			mSnapshot.clear();
+			mPending.clear();
+		}
+	}
+
+
+	///
+	/// Render finished handler
+	///
+	void PageImageCache::onRenderFinished()
+	{
+		QImage image = mRenderWatcher.result();
+
+		// Drop it if the model or settings changed while it was rendering
+		if ( mRendering.key == imageKey( mRendering.iPage, mRendering.size ) )
+		{
+			mImages.insert( mRendering.key, new QImage( image ), imageCost( image ) );
+
+			emit imageReady( mRendering.iPage, image );
+		}
+
+		renderNext();
+	}
+
+
+	///
+	/// Key of image of page at given size, under the current settings
+	///
+	QString PageImageCache::imageKey( int iPage, const QSize& size ) const
+	{
+		return QString( "%1/%2/%3x%4" ).arg( mSettingsKey ).arg( iPage ).arg( size.width() ).arg( size.height() );
+	}
+
+
+	///
+	/// Start rendering the most recent pending request, if idle
+	///
+	void PageImageCache::renderNext()
+	{
+		if ( mRenderWatcher.isRunning() || mPending.isEmpty() )
+		{
+			return;
+		}
+
+		if ( mSnapshot.isNull() )
+		{
+			mSnapshot = QSharedPointer<PageRenderer>( mRenderer->snapshot(), &QObject::deleteLater );
+		}
+
+		mRendering = mPending.takeFirst();
+
+		mRenderWatcher.setFuture( QtConcurrent::run( &PageImageCache::render,
+		                                             mSnapshot, mRendering.iPage, mRendering.size, mBackground ) );
+	}
+
+
+	///
+	/// Render page into image (runs in worker thread)
+	///
+	QImage PageImageCache::render( QSharedPointer<PageRenderer> snapshot, int iPage, QSize size, QColor background )
+	{
+		QImage image( size, QImage::Format_ARGB32_Premultiplied );
+		image.fill( background );
+
+		QRectF pageRect = snapshot->pageRect();
+		if ( pageRect.isEmpty() )
+		{
+			return image;
+		}
+
+		QPainter painter( &image );
+		painter.setRenderHint( QPainter::Antialiasing );
+		painter.scale( size.width()/pageRect.width(), size.height()/pageRect.height() );
+
+		snapshot->printPage( &painter, iPage );
+
+		return image;
+	}
+
+} // namespace glabels
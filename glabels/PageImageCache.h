@@ -0,0 +1,135 @@
+/*  PageImageCache.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PageImageCache_h
+#define PageImageCache_h
+
+
+#include <QCache>
+#include <QColor>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QSharedPointer>
+#include <QSize>
+#include <QString>
+
+
+namespace glabels
+{
+
+	// Forward references
+	class PageRenderer;
+
+
+	///
+	/// Page Image Cache
+	///
+	/// Pages of a PageRenderer are rendered into images on the global thread
+	/// pool, one at a time, from a snapshot of the renderer and its model.
+	/// Images are cached by page, size and the renderer's settings key, so
+	/// that pages already visited are shown at once.
+	///
+	/// At most maxPending requests wait to be rendered; newer requests are
+	/// rendered first and push the oldest ones out, so that scrubbing through
+	/// pages only renders the page last asked for.
+	///
+	class PageImageCache : public QObject
+	{
+		Q_OBJECT
+
+
+		/////////////////////////////////
+		// Life Cycle
+		/////////////////////////////////
+	public:
+		PageImageCache( int maxPending = 1, QObject* parent = nullptr );
+		~PageImageCache() override;
+
+
+		/////////////////////////////////
+		// Signals
+		/////////////////////////////////
+	signals:
+		void imageReady( int iPage, const QImage& image );
+
+
+		/////////////////////////////////
+		// Public methods
+		/////////////////////////////////
+	public:
+		void setRenderer( const PageRenderer* renderer );
+		void setBackground( const QColor& color );
+
+		///
+		/// Get image of page at given size.  If not yet available, a null image
+		/// is returned and imageReady() is emitted once it has been rendered.
+		///
+		QImage image( int iPage, const QSize& size );
+
+
+		/////////////////////////////////
+		// Private slots
+		/////////////////////////////////
+	private slots:
+		void onRendererChanged();
+		void onRenderFinished();
+
+
+		/////////////////////////////////
+		// Private methods
+		/////////////////////////////////
+	private:
+		struct Request
+		{
+			int     iPage;
+			QSize   size;
+			QString key;
+		};
+
+		QString imageKey( int iPage, const QSize& size ) const;
+		void renderNext();
+
+		static QImage render( QSharedPointer<PageRenderer> snapshot, int iPage, QSize size, QColor background );
+
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		const PageRenderer*          mRenderer;
+		QString                      mSettingsKey;
+		QSharedPointer<PageRenderer> mSnapshot;
+		QColor                       mBackground;
+
+		int                          mMaxPending;
+		QList<Request>               mPending;
+		Request                      mRendering;
+		QFutureWatcher<QImage>       mRenderWatcher;
+
+		QCache<QString,QImage>       mImages;
+
+	};
+
+}
+
+
+#endif // PageImageCache_h
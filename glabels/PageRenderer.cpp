@@ -47,7 +47,7 @@ namespace glabels
 	PageRenderer::PageRenderer()
 		: mModel(nullptr), mNCopies(0), mStartLabel(0),
 		  mPrintOutlines(false), mPrintCropMarks(false), mPrintReverse(false),
-		  mIsMerge(false), mIPage(0), mNPages(0)
+		  mIsMerge(false), mIPage(0), mNPages(0), mModelSerial(0), mCropMarksTemplate(nullptr)
 	{
 		// empty
 	}
@@ -71,12 +71,21 @@ namespace glabels
 
 	void PageRenderer::onModelChanged()
 	{
+		mModelSerial++;
+
 		mMerge = mModel->merge();
+		mSelectedRecords = mMerge->selectedRecords();
 		mOrigins = mModel->frame()->getOrigins();
 		mNLabelsPerPage = mModel->frame()->nLabels();
 		mIsMerge = ( dynamic_cast<const merge::None*>(mMerge) == nullptr );
 		updateNPages();
 
+		// Crop marks depend only on the template, which is immutable
+		if ( mModel->tmplate() != mCropMarksTemplate )
+		{
+			updateCropMarks();
+		}
+
 		emit changed();
 	}
 
@@ -131,6 +140,12 @@ namespace glabels
 	}
 
 	
+	int PageRenderer::iPage() const
+	{
+		return mIPage;
+	}
+
+	
 	int PageRenderer::nItems() const
 	{
 		return mLastLabel - mStartLabel;
@@ -156,13 +171,45 @@ namespace glabels
 	}
 			
 	
+	QString PageRenderer::settingsKey() const
+	{
+		return QString( "%1:%2:%3:%4:%5:%6:%7" )
+			.arg( quintptr(mModel) ).arg( mModelSerial )
+			.arg( mNCopies ).arg( mStartLabel )
+			.arg( mPrintOutlines ).arg( mPrintCropMarks ).arg( mPrintReverse );
+	}
+
+
+	PageRenderer* PageRenderer::snapshot() const
+	{
+		PageRenderer* renderer = new PageRenderer();
+
+		renderer->mNCopies        = mNCopies;
+		renderer->mStartLabel     = mStartLabel;
+		renderer->mPrintOutlines  = mPrintOutlines;
+		renderer->mPrintCropMarks = mPrintCropMarks;
+		renderer->mPrintReverse   = mPrintReverse;
+		renderer->mIPage          = mIPage;
+
+		if ( mModel )
+		{
+			LabelModel* model = mModel->save();
+			model->setParent( renderer );
+
+			renderer->setModel( model );
+		}
+
+		return renderer;
+	}
+
+	
 	void PageRenderer::updateNPages()
 	{
 		if ( mModel )
 		{
 			if ( mIsMerge )
 			{
-				mLastLabel = mStartLabel + mNCopies*mMerge->nSelectedRecords();
+				mLastLabel = mStartLabel + mNCopies*mSelectedRecords.size();
 			}
 			else
 			{
@@ -263,7 +310,8 @@ namespace glabels
 			iEnd = mLastLabel % mNLabelsPerPage;
 		}
 
-		const QList<merge::Record*> records = mMerge->selectedRecords();
+		// Selection changes are model changes, see onModelChanged()
+		const QList<merge::Record*>& records = mSelectedRecords;
 		if ( records.size() )
 		{
 			iRecord = (iPage*mNLabelsPerPage + iStart - mStartLabel) % records.size();
@@ -293,6 +341,58 @@ namespace glabels
 	}
 	
 	
+	void PageRenderer::updateCropMarks()
+	{
+		mCropMarksTemplate = mModel->tmplate();
+		mCropMarkLines.clear();
+
+		Distance w = mModel->frame()->w();
+		Distance h = mModel->frame()->h();
+
+		foreach ( Layout* layout, mModel->frame()->layouts() )
+		{
+			Distance xMin = layout->x0();
+			Distance yMin = layout->y0();
+			Distance xMax = layout->x0() + layout->dx()*(layout->nx()-1) + w;
+			Distance yMax = layout->y0() + layout->dy()*(layout->ny()-1) + h;
+
+			for ( int ix = 0; ix < layout->nx(); ix++ )
+			{
+				Distance x1 = xMin + ix*layout->dx();
+				Distance x2 = x1 + w;
+
+				Distance y1 = max( yMin-tickOffset, Distance::pt(0) );
+				Distance y2 = max( y1-tickLength, Distance::pt(0) );
+
+				Distance y3 = min( yMax+tickOffset, mModel->tmplate()->pageHeight() );
+				Distance y4 = min( y3+tickLength, mModel->tmplate()->pageHeight() );
+
+				mCropMarkLines << QLineF( x1.pt(), y1.pt(), x1.pt(), y2.pt() );
+				mCropMarkLines << QLineF( x2.pt(), y1.pt(), x2.pt(), y2.pt() );
+				mCropMarkLines << QLineF( x1.pt(), y3.pt(), x1.pt(), y4.pt() );
+				mCropMarkLines << QLineF( x2.pt(), y3.pt(), x2.pt(), y4.pt() );
+			}
+
+			for ( int iy = 0; iy < layout->ny(); iy++ )
+			{
+				Distance y1 = yMin + iy*layout->dy();
+				Distance y2 = y1 + h;
+
+				Distance x1 = max( xMin-tickOffset, Distance::pt(0) );
+				Distance x2 = max( x1-tickLength, Distance::pt(0) );
+
+				Distance x3 = min( xMax+tickOffset, mModel->tmplate()->pageWidth() );
+				Distance x4 = min( x3+tickLength, mModel->tmplate()->pageWidth() );
+
+				mCropMarkLines << QLineF( x1.pt(), y1.pt(), x2.pt(), y1.pt() );
+				mCropMarkLines << QLineF( x1.pt(), y2.pt(), x2.pt(), y2.pt() );
+				mCropMarkLines << QLineF( x3.pt(), y1.pt(), x4.pt(), y1.pt() );
+				mCropMarkLines << QLineF( x3.pt(), y2.pt(), x4.pt(), y2.pt() );
+			}
+		}
+	}
+
+
 	void PageRenderer::printCropMarks( QPainter* painter ) const
 	{
 		if ( mPrintCropMarks )
@@ -302,50 +402,7 @@ namespace glabels
 			painter->setBrush( QBrush( Qt::NoBrush ) );
 			painter->setPen( QPen( labelOutlineColor, labelOutlineWidth ) );
 
-			Distance w = mModel->frame()->w();
-			Distance h = mModel->frame()->h();
-
-			foreach ( Layout* layout, mModel->frame()->layouts() )
-			{
-				Distance xMin = layout->x0();
-				Distance yMin = layout->y0();
-				Distance xMax = layout->x0() + layout->dx()*(layout->nx()-1) + w;
-				Distance yMax = layout->y0() + layout->dy()*(layout->ny()-1) + h;
-
-				for ( int ix = 0; ix < layout->nx(); ix++ )
-				{
-					Distance x1 = xMin + ix*layout->dx();
-					Distance x2 = x1 + w;
-
-					Distance y1 = max( yMin-tickOffset, Distance::pt(0) );
-					Distance y2 = max( y1-tickLength, Distance::pt(0) );
-
-					Distance y3 = min( yMax+tickOffset, mModel->tmplate()->pageHeight() );
-					Distance y4 = min( y3+tickLength, mModel->tmplate()->pageHeight() );
-
-					painter->drawLine( x1.pt(), y1.pt(), x1.pt(), y2.pt() );
-					painter->drawLine( x2.pt(), y1.pt(), x2.pt(), y2.pt() );
-					painter->drawLine( x1.pt(), y3.pt(), x1.pt(), y4.pt() );
-					painter->drawLine( x2.pt(), y3.pt(), x2.pt(), y4.pt() );
-				}
-
-				for ( int iy = 0; iy < layout->ny(); iy++ )
-				{
-					Distance y1 = yMin + iy*layout->dy();
-					Distance y2 = y1 + h;
-
-					Distance x1 = max( xMin-tickOffset, Distance::pt(0) );
-					Distance x2 = max( x1-tickLength, Distance::pt(0) );
-
-					Distance x3 = min( xMax+tickOffset, mModel->tmplate()->pageWidth() );
-					Distance x4 = min( x3+tickLength, mModel->tmplate()->pageWidth() );
-
-					painter->drawLine( x1.pt(), y1.pt(), x2.pt(), y1.pt() );
-					painter->drawLine( x1.pt(), y2.pt(), x2.pt(), y2.pt() );
-					painter->drawLine( x3.pt(), y1.pt(), x4.pt(), y1.pt() );
-					painter->drawLine( x3.pt(), y2.pt(), x4.pt(), y2.pt() );
-				}
-			}
+			painter->drawLines( mCropMarkLines );
 
 			painter->restore();
 		}
@@ -27,6 +27,8 @@
 #include "Merge/Merge.h"
 #include "Merge/Record.h"
 
+#include <QLineF>
+#include <QList>
 #include <QPainter>
 #include <QRect>
 #include <QVector>
@@ -37,6 +39,7 @@ namespace glabels
 
 	// Forward references
 	class LabelModel;
+	class Template;
 
 
 	///
@@ -65,12 +68,26 @@ namespace glabels
 		void setPrintCropMarks( bool printCropMarksFlag );
 		void setPrintReverse( bool printReverseFlag );
 		void setIPage( int iPage );
+		int iPage() const;
 		int nItems() const;
 		int nPages() const;
 		QRectF pageRect() const;
 		void printPage( QPainter* painter ) const;
 		void printPage( QPainter* painter, int iPage ) const;
 
+		///
+		/// Key identifying everything that affects the rendered pages (model
+		/// contents and print settings), but not the current page.
+		///
+		QString settingsKey() const;
+
+		///
+		/// Copy of this renderer over a snapshot of its model, which owns the
+		/// snapshot.  Safe to print from a worker thread while the original
+		/// model is being edited.
+		///
+		PageRenderer* snapshot() const;
+
 
 		/////////////////////////////////
 		// Signals
@@ -91,6 +108,7 @@ namespace glabels
 		/////////////////////////////////
 	private:
 		void updateNPages();
+		void updateCropMarks();
 		void printSimplePage( QPainter* painter, int iPage ) const;
 		void printMergePage( QPainter* painter, int iPage ) const;
 		void printCropMarks( QPainter* painter ) const;
@@ -105,6 +123,7 @@ namespace glabels
 	private:
 		const LabelModel*   mModel;
 		const merge::Merge* mMerge;
+		QList<merge::Record*> mSelectedRecords;
 	
 		int               mNCopies;
 		int               mStartLabel;
@@ -117,8 +136,12 @@ namespace glabels
 		bool              mIsMerge;
 		int               mNPages;
 		int               mNLabelsPerPage;
+		quint32           mModelSerial;
 
 		QVector<Point>    mOrigins;
+
+		const Template*   mCropMarksTemplate;
+		QVector<QLineF>   mCropMarkLines;
 	};
 
 }
@@ -0,0 +1,185 @@
+/*  PageThumbnailModel.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PageThumbnailModel.h"
+
+#include "PageRenderer.h"
+
+
+namespace glabels
+{
+
+	//
+	// Private
+	//
+	namespace
+	{
+		const int thumbnailHeight = 96; // pixels
+
+		const QColor paperColor( 255, 255, 255 );
+
+		// Enough for the visible rows plus the prefetch window of PageThumbnailStrip
+		const int maxPendingThumbnails = 64;
+	}
+
+
+	///
+	/// Constructor
+	///
+	PageThumbnailModel::PageThumbnailModel( QObject *parent )
+		: QAbstractListModel(parent), mRenderer(nullptr), mNPages(0),
+		  mImages(maxPendingThumbnails)
+	{
+		mImages.setBackground( paperColor );
+
+		connect( &mImages, SIGNAL(imageReady(int,const QImage&)),
+		         this, SLOT(onImageReady(int,const QImage&)) );
+	}
+
+
+	///
+	/// Set Renderer
+	///
+	void PageThumbnailModel::setRenderer( const PageRenderer* renderer )
+	{
+		if ( mRenderer )
+		{
+			disconnect( mRenderer, SIGNAL(changed()), this, SLOT(onRendererChanged()) );
+		}
+
+		mRenderer = renderer;
+
+		// Connected first, so the cache sees renderer changes before we do
+		mImages.setRenderer( mRenderer );
+
+		connect( mRenderer, SIGNAL(changed()), this, SLOT(onRendererChanged()) );
+		onRendererChanged();
+	}
+
+
+	///
+	/// Size of Thumbnails
+	///
+	QSize PageThumbnailModel::thumbnailSize() const
+	{
+		return mThumbnailSize;
+	}
+
+
+	///
+	/// Request Thumbnails of Rows Ahead of Being Painted
+	///
+	void PageThumbnailModel::prefetch( int firstRow, int lastRow )
+	{
+		for ( int row = qMax( firstRow, 0 ); row <= qMin( lastRow, mNPages-1 ); row++ )
+		{
+			mImages.image( row, mThumbnailSize );
+		}
+	}
+
+
+	///
+	/// Row Count
+	///
+	int PageThumbnailModel::rowCount( const QModelIndex &parent ) const
+	{
+		return parent.isValid() ? 0 : mNPages;
+	}
+
+
+	///
+	/// Data of Row
+	///
+	QVariant PageThumbnailModel::data( const QModelIndex &index, int role ) const
+	{
+		if ( !index.isValid() || (index.row() >= mNPages) )
+		{
+			return QVariant();
+		}
+
+		switch ( role )
+		{
+		case Qt::DisplayRole:
+			return QString::number( index.row() + 1 );
+
+		case Qt::DecorationRole:
+			{
+				// Blank page while being rendered, see onImageReady()
+				QImage image = mImages.image( index.row(), mThumbnailSize );
+				return image.isNull() ? mPlaceholder : image;
+			}
+
+		default:
+			return QVariant();
+		}
+	}
+
+
+	///
+	/// Renderer Changed
+	///
+	void PageThumbnailModel::onRendererChanged()
+	{
+		QRectF pageRect = mRenderer->pageRect();
+
+		QSize thumbnailSize;
+		if ( pageRect.height() > 0 )
+		{
+			thumbnailSize = QSize( qRound( thumbnailHeight * pageRect.width() / pageRect.height() ),
+			                       thumbnailHeight );
+		}
+
+		if ( (mRenderer->nPages() != mNPages) || (thumbnailSize != mThumbnailSize) )
+		{
+			beginResetModel();
+			mNPages        = mRenderer->nPages();
+			mThumbnailSize = thumbnailSize;
+			mSettingsKey   = mRenderer->settingsKey();
+
+			mPlaceholder = QImage( mThumbnailSize, QImage::Format_ARGB32_Premultiplied );
+			mPlaceholder.fill( paperColor );
+
+			endResetModel();
+		}
+		else if ( mRenderer->settingsKey() != mSettingsKey )
+		{
+			// Same pages, new contents: have the view ask for them again
+			mSettingsKey = mRenderer->settingsKey();
+			if ( mNPages > 0 )
+			{
+				emit dataChanged( index( 0 ), index( mNPages-1 ), QVector<int>() << Qt::DecorationRole );
+			}
+		}
+	}
+
+
+	///
+	/// Thumbnail Rendered in Background
+	///
+	void PageThumbnailModel::onImageReady( int iPage, const QImage& image )
+	{
+		if ( iPage < mNPages )
+		{
+			QModelIndex rowIndex = index( iPage );
+			emit dataChanged( rowIndex, rowIndex, QVector<int>() << Qt::DecorationRole );
+		}
+	}
+
+} // namespace glabels
@@ -0,0 +1,109 @@
+/*  PageThumbnailModel.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PageThumbnailModel_h
+#define PageThumbnailModel_h
+
+
+#include "PageImageCache.h"
+
+#include <QAbstractListModel>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+
+namespace glabels
+{
+
+	// Forward references
+	class PageRenderer;
+
+
+	///
+	/// Page Thumbnail Model
+	///
+	/// One row per page of a PageRenderer.  Thumbnails are requested from a
+	/// PageImageCache only when a view asks for a row's decoration, i.e. when
+	/// the row is about to be painted, or when it is prefetched.  The most
+	/// recent requests are rendered first, so rows that are painted after
+	/// being prefetched take priority.
+	///
+	class PageThumbnailModel : public QAbstractListModel
+	{
+		Q_OBJECT
+
+
+		/////////////////////////////////
+		// Life Cycle
+		/////////////////////////////////
+	public:
+		PageThumbnailModel( QObject *parent = nullptr );
+
+
+		/////////////////////////////////
+		// Properties
+		/////////////////////////////////
+	public:
+		void setRenderer( const PageRenderer* renderer );
+		QSize thumbnailSize() const;
+
+
+		/////////////////////////////////
+		// Methods
+		/////////////////////////////////
+	public:
+		void prefetch( int firstRow, int lastRow );
+
+
+		/////////////////////////////////
+		// QAbstractListModel implementation
+		/////////////////////////////////
+	public:
+		int rowCount( const QModelIndex &parent = QModelIndex() ) const override;
+		QVariant data( const QModelIndex &index, int role = Qt::DisplayRole ) const override;
+
+
+		/////////////////////////////////
+		// Private slots
+		/////////////////////////////////
+	private slots:
+		void onRendererChanged();
+		void onImageReady( int iPage, const QImage& image );
+
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		const PageRenderer*     mRenderer;
+		int                     mNPages;
+		QString                 mSettingsKey;
+		QSize                   mThumbnailSize;
+		QImage                  mPlaceholder;
+
+		mutable PageImageCache  mImages;
+
+	};
+
+}
+
+
+#endif // PageThumbnailModel_h
@@ -0,0 +1,175 @@
+/*  PageThumbnailStrip.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PageThumbnailStrip.h"
+
+#include "PageThumbnailModel.h"
+
+#include <QItemSelectionModel>
+#include <QScrollBar>
+
+
+namespace glabels
+{
+
+	//
+	// Private
+	//
+	namespace
+	{
+		const int prefetchPages = 8; // on either side of the visible pages
+		const int stripSpacing  = 8; // pixels
+	}
+
+
+	///
+	/// Constructor
+	///
+	PageThumbnailStrip::PageThumbnailStrip( QWidget *parent ) : QListView(parent)
+	{
+		setViewMode( QListView::IconMode );
+		setFlow( QListView::LeftToRight );
+		setWrapping( false );
+		setSpacing( stripSpacing );
+		setUniformItemSizes( true );
+		setMovement( QListView::Static );
+		setSelectionMode( QAbstractItemView::SingleSelection );
+		setHorizontalScrollBarPolicy( Qt::ScrollBarAlwaysOn );
+		setVerticalScrollBarPolicy( Qt::ScrollBarAlwaysOff );
+
+		mModel = new PageThumbnailModel( this );
+		setModel( mModel );
+
+		connect( mModel, SIGNAL(modelReset()), this, SLOT(onModelReset()) );
+		connect( selectionModel(), SIGNAL(currentChanged(const QModelIndex&,const QModelIndex&)),
+		         this, SLOT(onCurrentChanged(const QModelIndex&,const QModelIndex&)) );
+	}
+
+
+	///
+	/// Set Renderer
+	///
+	void PageThumbnailStrip::setRenderer( const PageRenderer* renderer )
+	{
+		mModel->setRenderer( renderer );
+	}
+
+
+	///
+	/// Set Current Page
+	///
+	void PageThumbnailStrip::setCurrentPage( int iPage )
+	{
+		QModelIndex index = mModel->index( iPage );
+		if ( index.isValid() && (index != currentIndex()) )
+		{
+			setCurrentIndex( index );
+			scrollTo( index );
+		}
+	}
+
+
+	///
+	/// Scroll Event Handler
+	///
+	void PageThumbnailStrip::scrollContentsBy( int dx, int dy )
+	{
+		QListView::scrollContentsBy( dx, dy );
+		prefetch();
+	}
+
+
+	///
+	/// Resize Event Handler
+	///
+	void PageThumbnailStrip::resizeEvent( QResizeEvent* event )
+	{
+		QListView::resizeEvent( event );
+		prefetch();
+	}
+
+
+	///
+	/// Show Event Handler
+	///
+	void PageThumbnailStrip::showEvent( QShowEvent* event )
+	{
+		QListView::showEvent( event );
+		prefetch();
+	}
+
+
+	///
+	/// Model Reset Handler
+	///
+	void PageThumbnailStrip::onModelReset()
+	{
+		setIconSize( mModel->thumbnailSize() );
+		setFixedHeight( mModel->thumbnailSize().height() + fontMetrics().height()
+		                + 4*stripSpacing + horizontalScrollBar()->sizeHint().height() );
+		prefetch();
+	}
+
+
+	///
+	/// Current Item Changed Handler
+	///
+	void PageThumbnailStrip::onCurrentChanged( const QModelIndex& current, const QModelIndex& previous )
+	{
+		if ( current.isValid() )
+		{
+			emit pageSelected( current.row() );
+		}
+	}
+
+
+	///
+	/// Request Thumbnails of Pages Around the Visible Ones
+	///
+	/// Prefetched pages are requested before the visible ones are painted,
+	/// and the most recent requests are rendered first, so visible pages
+	/// still take priority.
+	///
+	void PageThumbnailStrip::prefetch()
+	{
+		// Rendering starts with a snapshot of the whole model, which is not
+		// worth taking for edits made while the strip is not shown.  Rows
+		// are requested again when painted after being shown.
+		int nRows = mModel->rowCount();
+		if ( (nRows == 0) || !isVisible() )
+		{
+			return;
+		}
+
+		QModelIndex first = indexAt( viewport()->rect().topLeft() + QPoint( stripSpacing, stripSpacing ) );
+		QModelIndex last  = indexAt( viewport()->rect().topRight() + QPoint( -stripSpacing, stripSpacing ) );
+
+		int firstRow = first.isValid() ? first.row() : 0;
+		int lastRow  = last.isValid()  ? last.row()  : nRows-1;
+
+		// Pages further away first, so the nearest are rendered first
+		for ( int distance = prefetchPages; distance > 0; distance-- )
+		{
+			mModel->prefetch( lastRow + distance, lastRow + distance );
+			mModel->prefetch( firstRow - distance, firstRow - distance );
+		}
+	}
+
+} // namespace glabels
@@ -0,0 +1,105 @@
+/*  PageThumbnailStrip.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PageThumbnailStrip_h
+#define PageThumbnailStrip_h
+
+
+#include <QListView>
+
+
+namespace glabels
+{
+
+	// Forward references
+	class PageRenderer;
+	class PageThumbnailModel;
+
+
+	///
+	/// Page Thumbnail Strip Widget
+	///
+	/// A horizontal strip with a thumbnail of every page.  Only the visible
+	/// thumbnails and a small window of pages on either side are rendered,
+	/// so long merge jobs cost no more than short ones.
+	///
+	class PageThumbnailStrip : public QListView
+	{
+		Q_OBJECT
+
+
+		/////////////////////////////////
+		// Life Cycle
+		/////////////////////////////////
+	public:
+		PageThumbnailStrip( QWidget *parent = nullptr );
+
+
+		/////////////////////////////////
+		// Signals
+		/////////////////////////////////
+	signals:
+		void pageSelected( int iPage );
+
+
+		/////////////////////////////////
+		// Properties
+		/////////////////////////////////
+	public:
+		void setRenderer( const PageRenderer* renderer );
+		void setCurrentPage( int iPage );
+
+
+		/////////////////////////////////
+		// Event handlers
+		/////////////////////////////////
+	protected:
+		void scrollContentsBy( int dx, int dy ) override;
+		void resizeEvent( QResizeEvent* event ) override;
+		void showEvent( QShowEvent* event ) override;
+
+
+		/////////////////////////////////
+		// Private slots
+		/////////////////////////////////
+	private slots:
+		void onModelReset();
+		void onCurrentChanged( const QModelIndex& current, const QModelIndex& previous );
+
+
+		/////////////////////////////////
+		// Private methods
+		/////////////////////////////////
+	private:
+		void prefetch();
+
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		PageThumbnailModel* mModel;
+
+	};
+
+}
+
+
+#endif // PageThumbnailStrip_h
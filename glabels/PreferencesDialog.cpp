@@ -26,6 +26,15 @@
 namespace glabels
 {
 
+	//
+	// Private
+	//
+	namespace
+	{
+		const qint64 bytesPerMiB = 1024*1024;
+	}
+
+
 	///
 	/// Constructor
 	///
@@ -52,6 +61,20 @@ namespace glabels
 			unitsPointsRadio->setChecked( true );
 			break;
 		}
+
+		autoSaveIntervalSpin->setValue( Settings::autoSaveInterval() );
+
+		qint64 budget = Settings::undoMemoryBudget();
+		undoBudgetSpin->setValue( budget > 0 ? int( qMax( budget/bytesPerMiB, qint64(1) ) ) : 0 );
+	}
+
+
+	///
+	/// Show memory currently used by the undo history of the calling window
+	///
+	void PreferencesDialog::setUndoMemoryUsage( qint64 nBytes )
+	{
+		undoUsageLabel->setText( tr("Currently used: %1 MiB").arg( double(nBytes)/bytesPerMiB, 0, 'f', 1 ) );
 	}
 
 
@@ -82,4 +105,29 @@ namespace glabels
 		}
 	}
 
+
+	///
+	/// Auto Save Interval Spin Changed
+	///
+	void PreferencesDialog::onAutoSaveIntervalChanged()
+	{
+		if ( autoSaveIntervalSpin->value() != Settings::autoSaveInterval() )
+		{
+			Settings::setAutoSaveInterval( autoSaveIntervalSpin->value() );
+		}
+	}
+
+
+	///
+	/// Undo Budget Spin Changed
+	///
+	void PreferencesDialog::onUndoBudgetChanged()
+	{
+		qint64 budget = undoBudgetSpin->value() * bytesPerMiB;
+		if ( budget != qMax( Settings::undoMemoryBudget(), qint64(0) ) )
+		{
+			Settings::setUndoMemoryBudget( budget );
+		}
+	}
+
 } // namespace glabels
@@ -42,11 +42,20 @@ namespace glabels
 		PreferencesDialog( QWidget *parent = nullptr );
 
 
+		/////////////////////////////////
+		// Public methods
+		/////////////////////////////////
+	public:
+		void setUndoMemoryUsage( qint64 nBytes );
+
+
 		/////////////////////////////////
 		// Slots
 		/////////////////////////////////
 	private slots:
 		void onUnitsRadiosChanged();
+		void onAutoSaveIntervalChanged();
+		void onUndoBudgetChanged();
 
 	};
 
@@ -24,7 +24,6 @@
 #include "PreviewOverlayItem.h"
 
 #include <QGraphicsDropShadowEffect>
-#include <QGraphicsRectItem>
 #include <QtDebug>
 
 
@@ -47,6 +46,10 @@ namespace glabels
 		const QColor  labelColor( 255, 255, 255 );
 		const QColor  labelOutlineColor( 215, 215, 215 );
 		const double  labelOutlineWidthPixels = 1;
+
+		const qreal   paperZValue   = 0;
+		const qreal   labelZValue   = 1;
+		const qreal   overlayZValue = 2;
 	}
 
 
@@ -54,7 +57,8 @@ namespace glabels
 	/// Constructor
 	///
 	Preview::Preview( QWidget *parent )
-		: mModel(nullptr), mRenderer(nullptr), QGraphicsView(parent)
+		: mModel(nullptr), mRenderer(nullptr), QGraphicsView(parent),
+		  mTemplate(nullptr), mPaperItem(nullptr), mOverlayItem(nullptr), mOverlayPage(-1)
 	{
 		mScene = new QGraphicsScene();
 		setScene( mScene );
@@ -64,6 +68,9 @@ namespace glabels
 
 		setFrameStyle( QFrame::NoFrame );
 		setRenderHints( QPainter::Antialiasing );
+
+		connect( &mPageImages, SIGNAL(imageReady(int,const QImage&)),
+		         this, SLOT(onPageImageReady(int,const QImage&)) );
 	}
 
 
@@ -72,8 +79,24 @@ namespace glabels
 	///
 	void Preview::setRenderer( const PageRenderer* renderer )
 	{
+		if ( mRenderer )
+		{
+			disconnect( mRenderer, SIGNAL(changed()), this, SLOT(onRendererChanged()) );
+		}
+
 		mRenderer = renderer;
 
+		// The overlay draws through the renderer, so it must be replaced
+		if ( mOverlayItem )
+		{
+			mScene->removeItem( mOverlayItem );
+			delete mOverlayItem;
+			mOverlayItem = nullptr;
+		}
+
+		// Connected first, so the cache sees renderer changes before we do
+		mPageImages.setRenderer( mRenderer );
+
 		connect( mRenderer, SIGNAL(changed()), this, SLOT(onRendererChanged()) );
 		onRendererChanged();
 	}
@@ -86,22 +109,55 @@ namespace glabels
 	{
 		mModel = mRenderer->model();
 
-		clearScene();
+		const Template* tmplate = mModel ? mModel->tmplate() : nullptr;
+
+		bool templateChanged = (tmplate != mTemplate);
+		if ( templateChanged )
+		{
+			// Templates are immutable, so page and label geometry only
+			// changes when the template itself changes.
+			mTemplate = tmplate;
+
+			if ( mTemplate != nullptr )
+			{
+				// Set scene up with a 5% margin around paper
+				Distance x = -0.05 * mTemplate->pageWidth();
+				Distance y = -0.05 * mTemplate->pageHeight();
+				Distance w = 1.10 * mTemplate->pageWidth();
+				Distance h = 1.10 * mTemplate->pageHeight();
+
+				mScene->setSceneRect( x.pt(), y.pt(), w.pt(), h.pt() );
+				fitInView( mScene->sceneRect(), Qt::KeepAspectRatio );
+
+				drawPaper( mTemplate->pageWidth(), mTemplate->pageHeight() );
+				drawLabels();
+			}
+			else
+			{
+				foreach ( QGraphicsItem *item, mScene->items() )
+				{
+					item->setVisible( false );
+				}
+			}
+		}
 
 		if ( mModel != nullptr )
 		{
-			// Set scene up with a 5% margin around paper
-			Distance x = -0.05 * mModel->tmplate()->pageWidth();
-			Distance y = -0.05 * mModel->tmplate()->pageHeight();
-			Distance w = 1.10 * mModel->tmplate()->pageWidth();
-			Distance h = 1.10 * mModel->tmplate()->pageHeight();
-
-			mScene->setSceneRect( x.pt(), y.pt(), w.pt(), h.pt() );
-			fitInView( mScene->sceneRect(), Qt::KeepAspectRatio );
-
-			drawPaper( mModel->tmplate()->pageWidth(), mModel->tmplate()->pageHeight() );
-			drawLabels();
-			drawPreviewOverlay();
+			drawPreviewOverlay( templateChanged );
+			updatePageImage();
+		}
+	}
+
+
+	///
+	/// Page image rendered in background
+	///
+	void Preview::onPageImageReady( int iPage, const QImage& image )
+	{
+		if ( mOverlayItem && (iPage == mRenderer->iPage()) && (image.size() == pageImageSize()) )
+		{
+			mOverlayItem->setImage( image );
+			mOverlayPage = iPage;
 		}
 	}
 
@@ -112,18 +168,25 @@ namespace glabels
 	void Preview::resizeEvent( QResizeEvent* event )
 	{
 		fitInView( mScene->sceneRect(), Qt::KeepAspectRatio );
+
+		if ( mModel != nullptr )
+		{
+			updatePageImage();
+		}
 	}
 
 
 	///
-	/// Clear View
+	/// Show Event Handler
 	///
-	void Preview::clearScene()
+	void Preview::showEvent( QShowEvent* event )
 	{
-		foreach ( QGraphicsItem *item, mScene->items() )
+		QGraphicsView::showEvent( event );
+
+		// Page images are not requested while hidden, see updatePageImage()
+		if ( mModel != nullptr )
 		{
-			mScene->removeItem( item );
-			delete item;
+			updatePageImage();
 		}
 	}
 
@@ -133,22 +196,30 @@ namespace glabels
 	///
 	void Preview::drawPaper( const Distance& pw, const Distance& ph )
 	{
-		QGraphicsDropShadowEffect *shadowEffect = new QGraphicsDropShadowEffect();
-		shadowEffect->setColor( shadowColor );
-		shadowEffect->setOffset( shadowOffsetPixels );
-		shadowEffect->setBlurRadius( shadowRadiusPixels );
-
-		QBrush brush( paperColor );
-		QPen pen( paperOutlineColor );
-		pen.setCosmetic( true );
-		pen.setWidthF( paperOutlineWidthPixels );
-
-		QGraphicsRectItem *pageItem = new QGraphicsRectItem( 0, 0, pw.pt(), ph.pt() );
-		pageItem->setBrush( brush );
-		pageItem->setPen( pen );
-		pageItem->setGraphicsEffect( shadowEffect );
-				
-		mScene->addItem( pageItem );
+		if ( mPaperItem == nullptr )
+		{
+			// Created once: the blur of the shadow effect is costly to set up
+			QGraphicsDropShadowEffect *shadowEffect = new QGraphicsDropShadowEffect();
+			shadowEffect->setColor( shadowColor );
+			shadowEffect->setOffset( shadowOffsetPixels );
+			shadowEffect->setBlurRadius( shadowRadiusPixels );
+
+			QBrush brush( paperColor );
+			QPen pen( paperOutlineColor );
+			pen.setCosmetic( true );
+			pen.setWidthF( paperOutlineWidthPixels );
+
+			mPaperItem = new QGraphicsRectItem();
+			mPaperItem->setBrush( brush );
+			mPaperItem->setPen( pen );
+			mPaperItem->setGraphicsEffect( shadowEffect );
+			mPaperItem->setZValue( paperZValue );
+
+			mScene->addItem( mPaperItem );
+		}
+
+		mPaperItem->setRect( 0, 0, pw.pt(), ph.pt() );
+		mPaperItem->setVisible( true );
 	}
 
 
@@ -157,45 +228,115 @@ namespace glabels
 	///
 	void Preview::drawLabels()
 	{
-		Frame *frame = mModel->tmplate()->frames().first();
+		Frame *frame = mTemplate->frames().first();
+		const QVector<Point>& origins = frame->getOrigins();
+
+		for ( int i = 0; i < origins.size(); i++ )
+		{
+			drawLabel( i, origins[i].x(), origins[i].y(), frame->path() );
+		}
 
-		foreach (Point origin, frame->getOrigins() )
+		// Drop items left over from a template with more labels
+		while ( mLabelItems.size() > origins.size() )
 		{
-			drawLabel( origin.x(), origin.y(), frame->path() );
+			QGraphicsPathItem *labelOutlineItem = mLabelItems.takeLast();
+			mScene->removeItem( labelOutlineItem );
+			delete labelOutlineItem;
 		}
 	}
 
 
 	///
-	/// Draw a Single Label at x,y
+	/// Draw a Single Label at x,y, reusing the i'th label item if it exists
 	///
-	void Preview::drawLabel( const Distance& x, const Distance& y, const QPainterPath& path )
+	void Preview::drawLabel( int i, const Distance& x, const Distance& y, const QPainterPath& path )
 	{
-		QBrush brush( Qt::NoBrush );
-		QPen pen( labelOutlineColor );
-		pen.setStyle( Qt::DotLine );
-		pen.setCosmetic( true );
-		pen.setWidthF( labelOutlineWidthPixels );
-
-		QGraphicsPathItem *labelOutlineItem  = new QGraphicsPathItem( path );
-		labelOutlineItem->setBrush( brush );
-		labelOutlineItem->setPen( pen );
-		labelOutlineItem->setPos( x.pt(), y.pt() );
+		if ( i >= mLabelItems.size() )
+		{
+			QBrush brush( Qt::NoBrush );
+			QPen pen( labelOutlineColor );
+			pen.setStyle( Qt::DotLine );
+			pen.setCosmetic( true );
+			pen.setWidthF( labelOutlineWidthPixels );
+
+			QGraphicsPathItem *labelOutlineItem  = new QGraphicsPathItem();
+			labelOutlineItem->setBrush( brush );
+			labelOutlineItem->setPen( pen );
+			labelOutlineItem->setZValue( labelZValue );
+
+			mScene->addItem( labelOutlineItem );
+			mLabelItems << labelOutlineItem;
+		}
 
-		mScene->addItem( labelOutlineItem );
+		// Both are no-ops for items whose geometry is unchanged
+		QGraphicsPathItem *labelOutlineItem = mLabelItems[i];
+		labelOutlineItem->setPath( path );
+		labelOutlineItem->setPos( x.pt(), y.pt() );
+		labelOutlineItem->setVisible( true );
 	}
 
 
 	///
 	/// Draw Preview Overlay
 	///
-	void Preview::drawPreviewOverlay()
+	void Preview::drawPreviewOverlay( bool geometryChanged )
 	{
 		if ( mRenderer )
 		{
-			PreviewOverlayItem* overlayItem = new PreviewOverlayItem( mRenderer );
-			mScene->addItem( overlayItem );
+			if ( mOverlayItem == nullptr )
+			{
+				mOverlayItem = new PreviewOverlayItem( mRenderer );
+				mOverlayItem->setZValue( overlayZValue );
+				mScene->addItem( mOverlayItem );
+			}
+			else if ( geometryChanged )
+			{
+				mOverlayItem->updateGeometry();
+			}
+			else
+			{
+				mOverlayItem->update();
+			}
+			mOverlayItem->setVisible( true );
 		}
 	}
 
+
+
+	///
+	/// Show image of current page, if already rendered
+	///
+	void Preview::updatePageImage()
+	{
+		// Rendering starts with a snapshot of the whole model, which is not
+		// worth taking for edits made while the print view is not shown.
+		if ( (mOverlayItem == nullptr) || !isVisible() )
+		{
+			return;
+		}
+
+		int iPage = mRenderer->iPage();
+
+		QImage image = mPageImages.image( iPage, pageImageSize() );
+
+		// While re-rendering the same page (e.g. after an edit), keep showing
+		// the previous image rather than flashing an empty page.
+		if ( !image.isNull() || (iPage != mOverlayPage) )
+		{
+			mOverlayItem->setImage( image );
+			mOverlayPage = iPage;
+		}
+	}
+
+
+	///
+	/// Size of page at view resolution, in device pixels
+	///
+	QSize Preview::pageImageSize() const
+	{
+		QRect rect = mapFromScene( mRenderer->pageRect() ).boundingRect();
+
+		return rect.size() * devicePixelRatio();
+	}
+
 } // namespace glabels
@@ -22,10 +22,14 @@
 #define Preview_h
 
 
+#include "PageImageCache.h"
 #include "PageRenderer.h"
 
+#include <QGraphicsPathItem>
+#include <QGraphicsRectItem>
 #include <QGraphicsView>
 #include <QGraphicsScene>
+#include <QList>
 
 
 namespace glabels
@@ -33,6 +37,8 @@ namespace glabels
 	
 	// Forward references
 	class LabelModel;
+	class PreviewOverlayItem;
+	class Template;
 
 
 	///
@@ -57,6 +63,7 @@ namespace glabels
 		void setRenderer( const PageRenderer* renderer );
 	private slots:
 		void onRendererChanged();
+		void onPageImageReady( int iPage, const QImage& image );
 
 
 		/////////////////////////////////////
@@ -64,18 +71,20 @@ namespace glabels
 		/////////////////////////////////////
 	protected:
 		void resizeEvent( QResizeEvent* event ) override;
+		void showEvent( QShowEvent* event ) override;
 
 		
 		/////////////////////////////////
 		// Internal Methods
 		/////////////////////////////////
 	private:
-		void clearScene();
 		void drawPaper( const Distance& pw, const Distance& ph );
 		void drawLabels();
-		void drawLabel( const Distance& x, const Distance& y, const QPainterPath& path );
+		void drawLabel( int i, const Distance& x, const Distance& y, const QPainterPath& path );
 		
-		void drawPreviewOverlay();
+		void drawPreviewOverlay( bool geometryChanged );
+		void updatePageImage();
+		QSize pageImageSize() const;
 
 
 		/////////////////////////////////
@@ -86,6 +95,15 @@ namespace glabels
 		const PageRenderer* mRenderer;    
 		QGraphicsScene*     mScene;
 
+		// Scene items are kept between renderer changes and only updated
+		const Template*            mTemplate;
+		QGraphicsRectItem*         mPaperItem;
+		QList<QGraphicsPathItem*>  mLabelItems;
+		PreviewOverlayItem*        mOverlayItem;
+		int                        mOverlayPage;
+
+		PageImageCache             mPageImages;
+
 	};
 
 }
@@ -35,6 +35,20 @@ namespace glabels
 	}
 
 
+	void PreviewOverlayItem::updateGeometry()
+	{
+		prepareGeometryChange();
+		update();
+	}
+
+
+	void PreviewOverlayItem::setImage( const QImage& image )
+	{
+		mImage = image;
+		update();
+	}
+
+
 	QRectF PreviewOverlayItem::boundingRect() const
 	{
 		return mRenderer->pageRect();
@@ -43,7 +57,11 @@ namespace glabels
 
 	void PreviewOverlayItem::paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget )
 	{
-		mRenderer->printPage( painter );
+		// Rendered in the background by Preview, see PageImageCache
+		if ( !mImage.isNull() )
+		{
+			painter->drawImage( boundingRect(), mImage );
+		}
 	}
 
 } // namespace glabels
@@ -23,6 +23,7 @@
 
 
 #include <QGraphicsItem>
+#include <QImage>
 
 
 namespace glabels
@@ -45,6 +46,14 @@ namespace glabels
 		PreviewOverlayItem( const PageRenderer* renderer, QGraphicsItem* parent = nullptr );
 
 
+		/////////////////////////////////
+		// Public Methods
+		/////////////////////////////////
+	public:
+		void updateGeometry();
+		void setImage( const QImage& image );
+
+
 		/////////////////////////////////////
 		// Virtual method implementations
 		/////////////////////////////////////
@@ -58,6 +67,7 @@ namespace glabels
 		/////////////////////////////////
 	private:
 		const PageRenderer* mRenderer;
+		QImage              mImage;
 
 	};
 
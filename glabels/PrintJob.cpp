@@ -0,0 +1,153 @@
+/*  PrintJob.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrintJob.h"
+
+#include "PageRenderer.h"
+
+#include <QPainter>
+#include <QtConcurrent>
+#include <QtDebug>
+
+
+namespace glabels
+{
+
+	///
+	/// Constructor
+	///
+	/// Takes ownership of printer, which must already be set up.
+	///
+	PrintJob::PrintJob( const PageRenderer* renderer, QPrinter* printer, QObject* parent )
+		: QObject(parent),
+		  mSnapshot( renderer->snapshot(), &QObject::deleteLater ),
+		  mPrinter( printer ),
+		  mNPages( renderer->nPages() ),
+		  mCancelled( 0 )
+	{
+		connect( &mPrintWatcher, SIGNAL(finished()), this, SLOT(onPrintFinished()) );
+	}
+
+
+	///
+	/// Destructor
+	///
+	PrintJob::~PrintJob()
+	{
+		cancel();
+		waitForFinished();
+	}
+
+
+	///
+	/// Number of Pages to Print
+	///
+	int PrintJob::nPages() const
+	{
+		return mNPages;
+	}
+
+
+	///
+	/// Start Printing in Background
+	///
+	void PrintJob::start()
+	{
+		mTimer.start();
+		mPrintWatcher.setFuture( QtConcurrent::run( this, &PrintJob::print ) );
+	}
+
+
+	///
+	/// Cancel Printing, after the page being printed
+	///
+	void PrintJob::cancel()
+	{
+		mCancelled.storeRelease( 1 );
+	}
+
+
+	///
+	/// Is Job Still Printing?
+	///
+	bool PrintJob::isRunning() const
+	{
+		return mPrintWatcher.isRunning();
+	}
+
+
+	///
+	/// Wait for Job to Finish
+	///
+	void PrintJob::waitForFinished()
+	{
+		mPrintWatcher.waitForFinished();
+	}
+
+
+	///
+	/// Printing Finished Handler
+	///
+	void PrintJob::onPrintFinished()
+	{
+		emit finished( mPrintWatcher.result() );
+	}
+
+
+	///
+	/// Print All Pages (runs in worker thread)
+	///
+	bool PrintJob::print()
+	{
+		QPainter painter;
+		if ( !painter.begin( mPrinter.data() ) )
+		{
+			qWarning() << "Cannot start print job.";
+			return false;
+		}
+
+		QSizeF sizePx  = mPrinter->paperSize( QPrinter::DevicePixel );
+		QSizeF sizePts = mPrinter->paperSize( QPrinter::Point );
+		painter.scale( sizePx.width()/sizePts.width(), sizePx.height()/sizePts.height() );
+
+		for ( int iPage = 0; iPage < mNPages; iPage++ )
+		{
+			if ( mCancelled.loadAcquire() )
+			{
+				mPrinter->abort();
+				return false;
+			}
+
+			if ( iPage )
+			{
+				mPrinter->newPage();
+			}
+
+			mSnapshot->printPage( &painter, iPage );
+
+			// Queued to the GUI thread, where this job lives
+			double seconds = mTimer.elapsed() / 1000.0;
+			emit progress( iPage+1, mNPages, (seconds > 0) ? (iPage+1)/seconds : 0 );
+		}
+
+		return painter.end();
+	}
+
+} // namespace glabels
@@ -0,0 +1,113 @@
+/*  PrintJob.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PrintJob_h
+#define PrintJob_h
+
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QPrinter>
+#include <QSharedPointer>
+
+
+namespace glabels
+{
+
+	// Forward references
+	class PageRenderer;
+
+
+	///
+	/// Print Job
+	///
+	/// Prints all pages of a renderer on a worker thread, so that the label
+	/// can be edited while it prints.  The job prints from a snapshot of the
+	/// renderer and its model (see PageRenderer::snapshot()) and owns its
+	/// printer.  Pages are drawn and handed to the printer one at a time, so
+	/// memory use does not grow with the number of pages.
+	///
+	class PrintJob : public QObject
+	{
+		Q_OBJECT
+
+
+		/////////////////////////////////
+		// Life Cycle
+		/////////////////////////////////
+	public:
+		PrintJob( const PageRenderer* renderer, QPrinter* printer, QObject* parent = nullptr );
+		~PrintJob() override;
+
+
+		/////////////////////////////////
+		// Signals
+		/////////////////////////////////
+	signals:
+		void progress( int nPagesPrinted, int nPages, double pagesPerSecond );
+		void finished( bool completed );
+
+
+		/////////////////////////////////
+		// Public methods
+		/////////////////////////////////
+	public:
+		int nPages() const;
+
+		void start();
+		void cancel();
+		bool isRunning() const;
+		void waitForFinished();
+
+
+		/////////////////////////////////
+		// Private slots
+		/////////////////////////////////
+	private slots:
+		void onPrintFinished();
+
+
+		/////////////////////////////////
+		// Private methods
+		/////////////////////////////////
+	private:
+		bool print();
+
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		QSharedPointer<PageRenderer> mSnapshot;
+		QSharedPointer<QPrinter>     mPrinter;
+		int                          mNPages;
+
+		QAtomicInt                   mCancelled;
+		QElapsedTimer                mTimer;
+		QFutureWatcher<bool>         mPrintWatcher;
+
+	};
+
+}
+
+
+#endif // PrintJob_h
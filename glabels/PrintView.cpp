@@ -21,25 +21,65 @@
 #include "PrintView.h"
 
 #include "LabelModel.h"
+#include "PrintJob.h"
 
 #include <QPrintDialog>
+#include <QProgressDialog>
+#include <QTime>
 #include <QtDebug>
 
 
 namespace glabels
 {
 
+	//
+	// Private
+	//
+	namespace
+	{
+		///
+		/// Copy of a printer as configured by the print dialog, for a print job
+		///
+		QPrinter* copyPrinter( const QPrinter* printer )
+		{
+			QPrinter* copy = new QPrinter( QPrinter::HighResolution );
+
+			copy->setPrinterName( printer->printerName() );
+			copy->setOutputFormat( printer->outputFormat() );
+			copy->setOutputFileName( printer->outputFileName() );
+			copy->setDocName( printer->docName() );
+			copy->setCreator( printer->creator() );
+
+			copy->setPageLayout( printer->pageLayout() );
+			copy->setFullPage( printer->fullPage() );
+
+			copy->setCopyCount( printer->copyCount() );
+			copy->setCollateCopies( printer->collateCopies() );
+			copy->setPageOrder( printer->pageOrder() );
+			copy->setDuplex( printer->duplex() );
+			copy->setColorMode( printer->colorMode() );
+			copy->setPaperSource( printer->paperSource() );
+
+			return copy;
+		}
+	}
+
+
 	///
 	/// Constructor
 	///
 	PrintView::PrintView( QWidget *parent )
-		: QWidget(parent), mModel(nullptr), mBlocked(false)
+		: QWidget(parent), mModel(nullptr), mBlocked(false),
+		  mPrintJob(nullptr), mPrintProgress(nullptr)
 	{
 		setupUi( this );
 
 		titleLabel->setText( QString( "<span style='font-size:18pt;'>%1</span>" ).arg( tr("Print") ) );
 
 		preview->setRenderer( &mRenderer );
+		thumbnailStrip->setRenderer( &mRenderer );
+
+		connect( thumbnailStrip, SIGNAL(pageSelected(int)), this, SLOT(onThumbnailSelected(int)) );
 		mPrinter = new QPrinter( QPrinter::HighResolution );
 	}
 
@@ -49,6 +89,8 @@ namespace glabels
 	///
 	PrintView::~PrintView()
 	{
+		// Cancels and waits for a job still printing
+		delete mPrintJob;
 		delete mPrinter;
 	}
 
@@ -88,6 +130,8 @@ namespace glabels
 
 		pageSpin->setRange( 1, mRenderer.nPages() );
 		nPagesLabel->setText( QString::number( mRenderer.nPages() ) );
+
+		thumbnailStrip->setCurrentPage( pageSpin->value() - 1 );
 	}
 
 
@@ -116,6 +160,15 @@ namespace glabels
 	}
 
 
+	///
+	/// Thumbnail selected handler
+	///
+	void PrintView::onThumbnailSelected( int iPage )
+	{
+		pageSpin->setValue( iPage + 1 );
+	}
+
+
 	///
 	/// Print Button Clicked handler
 	///
@@ -137,22 +190,82 @@ namespace glabels
 
 		if ( printDialog.exec() == QDialog::Accepted )
 		{
-			QPainter painter( mPrinter );
-			
-			QSizeF sizePx  = mPrinter->paperSize( QPrinter::DevicePixel );
-			QSizeF sizePts = mPrinter->paperSize( QPrinter::Point );
-			painter.scale( sizePx.width()/sizePts.width(), sizePx.height()/sizePts.height() );
+			// The job gets its own copy, so mPrinter keeps the dialog's settings for next time
+			mPrintJob = new PrintJob( &mRenderer, copyPrinter( mPrinter ) );
+
+			mPrintProgress = new QProgressDialog( this );
+			mPrintProgress->setWindowModality( Qt::NonModal );
+			mPrintProgress->setWindowTitle( tr("Print") );
+			mPrintProgress->setLabelText( tr("Printing...") );
+			mPrintProgress->setRange( 0, mPrintJob->nPages() );
+			mPrintProgress->setMinimumDuration( 0 );
+			mPrintProgress->setAutoClose( false );
+			mPrintProgress->setAutoReset( false );
+
+			connect( mPrintJob, SIGNAL(progress(int,int,double)), this, SLOT(onPrintProgress(int,int,double)) );
+			connect( mPrintJob, SIGNAL(finished(bool)), this, SLOT(onPrintFinished(bool)) );
+			connect( mPrintProgress, SIGNAL(canceled()), this, SLOT(onPrintCanceled()) );
+
+			// One job at a time; the label itself can still be edited
+			printButton->setEnabled( false );
+
+			mPrintJob->start();
+		}
+	}
 
-			for ( int iPage = 0; iPage < mRenderer.nPages(); iPage++ )
-			{
-				if ( iPage )
-				{
-					mPrinter->newPage();
-				}
 
-				mRenderer.printPage( &painter, iPage );
+	///
+	/// Print job progress handler
+	///
+	void PrintView::onPrintProgress( int nPagesPrinted, int nPages, double pagesPerSecond )
+	{
+		if ( mPrintProgress && !mPrintProgress->wasCanceled() )
+		{
+			QString remaining;
+			if ( pagesPerSecond > 0 )
+			{
+				QTime eta = QTime( 0, 0 ).addSecs( qRound( (nPages - nPagesPrinted) / pagesPerSecond ) );
+				remaining = eta.toString( "h:mm:ss" );
 			}
+
+			mPrintProgress->setLabelText( tr("Printing page %1 of %2 (%3 pages/s, %4 remaining)")
+			                              .arg( nPagesPrinted ).arg( nPages )
+			                              .arg( pagesPerSecond, 0, 'f', 1 ).arg( remaining ) );
+			mPrintProgress->setValue( nPagesPrinted );
+		}
+	}
+
+
+	///
+	/// Print job cancel handler
+	///
+	void PrintView::onPrintCanceled()
+	{
+		if ( mPrintJob )
+		{
+			mPrintJob->cancel();
+			mPrintProgress->setLabelText( tr("Canceling...") );
 		}
 	}
 
+
+	///
+	/// Print job finished handler
+	///
+	void PrintView::onPrintFinished( bool completed )
+	{
+		if ( !completed && !mPrintProgress->wasCanceled() )
+		{
+			qWarning() << "Print job failed.";
+		}
+
+		mPrintProgress->deleteLater();
+		mPrintProgress = nullptr;
+
+		mPrintJob->deleteLater();
+		mPrintJob = nullptr;
+
+		printButton->setEnabled( true );
+	}
+
 } // namespace glabels
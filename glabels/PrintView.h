@@ -27,6 +27,7 @@
 #include "PageRenderer.h"
 
 #include <QPrinter>
+#include <QProgressDialog>
 
 
 namespace glabels
@@ -34,6 +35,7 @@ namespace glabels
 
 	// Forward references
 	class LabelModel;
+	class PrintJob;
 	
 
 	///
@@ -65,7 +67,11 @@ namespace glabels
 		void onModelChanged();
 		void updateView();
 		void onFormChanged();
+		void onThumbnailSelected( int iPage );
 		void onPrintButtonClicked();
+		void onPrintProgress( int nPagesPrinted, int nPages, double pagesPerSecond );
+		void onPrintCanceled();
+		void onPrintFinished( bool completed );
 
 
 		/////////////////////////////////
@@ -78,6 +84,9 @@ namespace glabels
 
 		bool         mBlocked;
 
+		PrintJob*        mPrintJob;
+		QProgressDialog* mPrintProgress;
+
 	};
 
 }
@@ -22,7 +22,6 @@
 
 #include "Db.h"
 #include "Settings.h"
-#include "TemplatePickerItem.h"
 
 #include <QtDebug>
 
@@ -63,6 +62,8 @@ namespace glabels
 		QList<Template*> tmplates = Db::templates();
 		templatePicker->setTemplates( tmplates );
 
+		connect( Db::instance(), SIGNAL(changed()), this, SLOT(onDbChanged()) );
+
 		if ( Settings::recentTemplateList().count() > 0 )
 		{
 			modeNotebook->setCurrentIndex(1);
@@ -213,6 +214,18 @@ namespace glabels
 	}
 
 
+	///
+	/// Db Changed Slot
+	///
+	void SelectProductDialog::onDbChanged()
+	{
+		// Rebuilds the picker's search index too
+		templatePicker->setTemplates( Db::templates() );
+
+		onModeTabChanged();
+	}
+
+
 	///
 	/// Cancel Button Clicked Slot
 	///
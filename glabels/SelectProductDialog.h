@@ -63,6 +63,7 @@ namespace glabels
 		void onCategoryCheckClicked();
 		void onTemplatePickerSelectionChanged();
 		void onCancelButtonClicked();
+		void onDbChanged();
 
 		
 		/////////////////////////////////
@@ -258,4 +258,50 @@ namespace glabels
 		emit mInstance->changed();
 	}
 
+
+	qint64 Settings::undoMemoryBudget()
+	{
+		// Default: 64 MiB
+		qint64 defaultValue = 64*1024*1024;
+
+		mInstance->beginGroup( "Undo" );
+		qint64 returnValue = mInstance->value( "memoryBudget", defaultValue ).toLongLong();
+		mInstance->endGroup();
+
+		return returnValue;
+	}
+
+
+	void Settings::setUndoMemoryBudget( qint64 nBytes )
+	{
+		mInstance->beginGroup( "Undo" );
+		mInstance->setValue( "memoryBudget", nBytes );
+		mInstance->endGroup();
+
+		emit mInstance->changed();
+	}
+
+
+	int Settings::autoSaveInterval()
+	{
+		// Default: 5 minutes, 0 = disabled
+		int defaultValue = 5;
+
+		mInstance->beginGroup( "AutoSave" );
+		int returnValue = mInstance->value( "interval", defaultValue ).toInt();
+		mInstance->endGroup();
+
+		return returnValue;
+	}
+
+
+	void Settings::setAutoSaveInterval( int minutes )
+	{
+		mInstance->beginGroup( "AutoSave" );
+		mInstance->setValue( "interval", minutes );
+		mInstance->endGroup();
+
+		emit mInstance->changed();
+	}
+
 } // namespace glabels
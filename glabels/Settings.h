@@ -85,6 +85,12 @@ namespace glabels
 		static QStringList recentTemplateList();
 		static void addToRecentTemplateList( const QString& name );
 
+		static qint64 undoMemoryBudget();
+		static void setUndoMemoryBudget( qint64 nBytes );
+
+		static int autoSaveInterval();
+		static void setAutoSaveInterval( int minutes );
+
 
 	private:
 		static Settings* mInstance;
@@ -0,0 +1,237 @@
+/*  SpatialIndex.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SpatialIndex.h"
+
+#include <QSet>
+#include <QtMath>
+
+
+namespace glabels
+{
+
+	//
+	// Private
+	//
+	namespace
+	{
+		// Objects covering more cells than this are kept in a separate list,
+		// which is always searched, rather than being entered into every cell.
+		const int maxCellsPerObject = 1024;
+	}
+
+
+	///
+	/// Constructor
+	///
+	SpatialIndex::SpatialIndex( double cellSizePts ) : mCellSize(cellSizePts)
+	{
+		// empty
+	}
+
+
+	///
+	/// Insert object
+	///
+	void SpatialIndex::insert( LabelModelObject* object, const QRectF& bounds )
+	{
+		if ( mBounds.contains( object ) )
+		{
+			remove( object );
+		}
+
+		mBounds.insert( object, bounds );
+
+		int i1, j1, i2, j2;
+		if ( cellRange( bounds, i1, j1, i2, j2 ) )
+		{
+			for ( int i = i1; i <= i2; i++ )
+			{
+				for ( int j = j1; j <= j2; j++ )
+				{
+					mCells[ cellKey( i, j ) ].append( object );
+				}
+			}
+		}
+		else
+		{
+			mOversized.append( object );
+		}
+	}
+
+
+	///
+	/// Update bounds of object
+	///
+	void SpatialIndex::update( LabelModelObject* object, const QRectF& bounds )
+	{
+		if ( mBounds.contains( object ) && (mBounds.value( object ) == bounds) )
+		{
+			return;
+		}
+
+		insert( object, bounds );
+	}
+
+
+	///
+	/// Remove object
+	///
+	void SpatialIndex::remove( LabelModelObject* object )
+	{
+		if ( !mBounds.contains( object ) )
+		{
+			return;
+		}
+
+		QRectF bounds = mBounds.take( object );
+
+		int i1, j1, i2, j2;
+		if ( cellRange( bounds, i1, j1, i2, j2 ) )
+		{
+			for ( int i = i1; i <= i2; i++ )
+			{
+				for ( int j = j1; j <= j2; j++ )
+				{
+					quint64 key = cellKey( i, j );
+
+					QList<LabelModelObject*>& cell = mCells[ key ];
+					cell.removeOne( object );
+					if ( cell.isEmpty() )
+					{
+						mCells.remove( key );
+					}
+				}
+			}
+		}
+		else
+		{
+			mOversized.removeOne( object );
+		}
+	}
+
+
+	///
+	/// Clear index
+	///
+	void SpatialIndex::clear()
+	{
+		mBounds.clear();
+		mCells.clear();
+		mOversized.clear();
+	}
+
+
+	///
+	/// Get all objects whose bounding boxes intersect rect
+	///
+	QList<LabelModelObject*> SpatialIndex::query( const QRectF& rect ) const
+	{
+		QList<LabelModelObject*> candidates;
+		QSet<LabelModelObject*>  seen;
+
+		int i1, j1, i2, j2;
+		if ( cellRange( rect, i1, j1, i2, j2 ) )
+		{
+			for ( int i = i1; i <= i2; i++ )
+			{
+				for ( int j = j1; j <= j2; j++ )
+				{
+					auto it = mCells.constFind( cellKey( i, j ) );
+					if ( it == mCells.constEnd() )
+					{
+						continue;
+					}
+
+					foreach ( LabelModelObject* object, it.value() )
+					{
+						if ( !seen.contains( object ) && mBounds.value( object ).intersects( rect ) )
+						{
+							seen.insert( object );
+							candidates.append( object );
+						}
+					}
+				}
+			}
+		}
+		else
+		{
+			// Query is too big to be worth walking the grid
+			for ( auto it = mBounds.constBegin(); it != mBounds.constEnd(); ++it )
+			{
+				if ( it.value().intersects( rect ) )
+				{
+					seen.insert( it.key() );
+					candidates.append( it.key() );
+				}
+			}
+			return candidates;
+		}
+
+		foreach ( LabelModelObject* object, mOversized )
+		{
+			if ( !seen.contains( object ) && mBounds.value( object ).intersects( rect ) )
+			{
+				candidates.append( object );
+			}
+		}
+
+		return candidates;
+	}
+
+
+	///
+	/// Get range of cells covered by rect.  Returns false if rect is unusable or too large.
+	///
+	bool SpatialIndex::cellRange( const QRectF& rect, int& i1, int& j1, int& i2, int& j2 ) const
+	{
+		QRectF r = rect.normalized();
+
+		if ( !qIsFinite( r.left() ) || !qIsFinite( r.top() ) ||
+		     !qIsFinite( r.right() ) || !qIsFinite( r.bottom() ) )
+		{
+			return false;
+		}
+
+		double wCells = r.width() / mCellSize;
+		double hCells = r.height() / mCellSize;
+		if ( (wCells+1)*(hCells+1) > maxCellsPerObject )
+		{
+			return false;
+		}
+
+		i1 = qFloor( r.left()   / mCellSize );
+		j1 = qFloor( r.top()    / mCellSize );
+		i2 = qFloor( r.right()  / mCellSize );
+		j2 = qFloor( r.bottom() / mCellSize );
+
+		return true;
+	}
+
+
+	///
+	/// Hash key of cell i,j
+	///
+	quint64 SpatialIndex::cellKey( int i, int j )
+	{
+		return (quint64(quint32(i)) << 32) | quint64(quint32(j));
+	}
+
+} // namespace glabels
@@ -0,0 +1,93 @@
+/*  SpatialIndex.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SpatialIndex_h
+#define SpatialIndex_h
+
+
+#include <QHash>
+#include <QList>
+#include <QRectF>
+
+
+namespace glabels
+{
+
+	// Forward References
+	class LabelModelObject;
+
+
+	///
+	/// Spatial Index
+	///
+	/// Uniform grid of label model objects, keyed by their bounding boxes in
+	/// label coordinates.  Used to narrow down the candidate objects before doing
+	/// precise (path based) hit tests.
+	///
+	class SpatialIndex
+	{
+
+		/////////////////////////////////
+		// Lifecycle
+		/////////////////////////////////
+	public:
+		SpatialIndex( double cellSizePts = 36 );
+
+
+		/////////////////////////////////
+		// Maintenance
+		/////////////////////////////////
+	public:
+		void insert( LabelModelObject* object, const QRectF& bounds );
+		void update( LabelModelObject* object, const QRectF& bounds );
+		void remove( LabelModelObject* object );
+		void clear();
+
+
+		/////////////////////////////////
+		// Queries
+		/////////////////////////////////
+	public:
+		QList<LabelModelObject*> query( const QRectF& rect ) const;
+
+
+		/////////////////////////////////
+		// Private methods
+		/////////////////////////////////
+	private:
+		bool cellRange( const QRectF& rect, int& i1, int& j1, int& i2, int& j2 ) const;
+		static quint64 cellKey( int i, int j );
+
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		double                                   mCellSize;
+
+		QHash<LabelModelObject*,QRectF>          mBounds;
+		QHash<quint64,QList<LabelModelObject*>>  mCells;
+		QList<LabelModelObject*>                 mOversized;
+	};
+
+}
+
+
+#endif // SpatialIndex_h
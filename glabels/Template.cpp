@@ -207,15 +207,15 @@ namespace glabels
 	}
 	
 
-	const MiniPreviewPixmap& Template::preview() const
+	const QList<Frame*>& Template::frames() const
 	{
-		return mPreview;
+		return mFrames;
 	}
-	
 
-	const QList<Frame*>& Template::frames() const
+
+	const QStringList& Template::categoryIds() const
 	{
-		return mFrames;
+		return mCategoryIds;
 	}
 
 
@@ -231,12 +231,6 @@ namespace glabels
 	}
 
 
-	void Template::initPreview()
-	{
-		mPreview = MiniPreviewPixmap( this, TEMPLATE_PREVIEW_SIZE, TEMPLATE_PREVIEW_SIZE );
-	}
-
-
 	bool Template::operator==( const Template& other ) const
 	{
 		return (mBrand == other.mBrand) && (mPart == other.mPart);
@@ -24,7 +24,6 @@
 
 #include "Distance.h"
 #include "Frame.h"
-#include "MiniPreviewPixmap.h"
 #include "Point.h"
 
 #include <QCoreApplication>
@@ -84,12 +83,10 @@ namespace glabels
 
 		QString name() const;
 
+		const QStringList& categoryIds() const;
 		void addCategory( const QString& categoryId );
 		void addFrame( Frame* frame );
 
-		void initPreview();
-		const MiniPreviewPixmap& preview() const;
-
 		const QList<Frame*>& frames() const;
 
 		bool operator==( const Template& other ) const;
@@ -116,8 +113,6 @@ namespace glabels
 		QStringList    mCategoryIds;
 
 		QList<Frame*>  mFrames;
-
-		MiniPreviewPixmap mPreview;
 	};
 
 }
@@ -20,9 +20,10 @@
 
 #include "TemplatePicker.h"
 
-#include "TemplatePickerItem.h"
+#include "TemplatePickerFilterModel.h"
+#include "TemplatePickerModel.h"
 
-#include <QIcon>
+#include <QItemSelectionModel>
 
 
 namespace glabels
@@ -31,14 +32,23 @@ namespace glabels
 	///
 	/// Constructor
 	///
-	TemplatePicker::TemplatePicker( QWidget *parent ) : QListWidget(parent)
+	TemplatePicker::TemplatePicker( QWidget *parent ) : QListView(parent)
 	{
 		setViewMode( QListView::IconMode );
 		setResizeMode( QListView::Adjust );
 		setSpacing( 24 );
 		setWordWrap( true );
 		setUniformItemSizes( true );
+		setMovement( QListView::Static );
 		setIconSize( QSize(TEMPLATE_PREVIEW_SIZE, TEMPLATE_PREVIEW_SIZE) );
+
+		mModel = new TemplatePickerModel( this );
+		mFilterModel = new TemplatePickerFilterModel( this );
+		mFilterModel->setSourceModel( mModel );
+		setModel( mFilterModel );
+
+		connect( selectionModel(), SIGNAL(selectionChanged(const QItemSelection&,const QItemSelection&)),
+		         this, SIGNAL(itemSelectionChanged()) );
 	}
 
 
@@ -47,10 +57,9 @@ namespace glabels
 	///
 	void TemplatePicker::setTemplates( const QList <Template*> &tmplates )
 	{
-		foreach (Template *tmplate, tmplates)
-		{
-			new TemplatePickerItem( tmplate, this );
-		}
+		mModel->setTemplates( tmplates );
+		mSearchIndex.build( tmplates );
+		mFilterModel->setMask( QBitArray() );
 	}
 
 
@@ -61,42 +70,9 @@ namespace glabels
 	                                  bool isoMask, bool usMask, bool otherMask,
 	                                  bool anyCategory, const QStringList& categoryIds )
 	{
-		foreach ( QListWidgetItem *item, findItems( "*", Qt::MatchWildcard ) )
-		{
-			TemplatePickerItem *tItem = dynamic_cast<TemplatePickerItem *>(item);
-
-			bool nameMask = tItem->tmplate()->name().contains( searchString, Qt::CaseInsensitive );
-		
-			bool sizeMask =
-				(isoMask   && tItem->tmplate()->isSizeIso())   ||
-				(usMask    && tItem->tmplate()->isSizeUs())    ||
-				(otherMask && tItem->tmplate()->isSizeOther());
-
-			bool categoryMask;
-			if ( anyCategory )
-			{
-				categoryMask = true;
-			}
-			else
-			{
-				categoryMask = false;
-				foreach ( QString id, categoryIds )
-				{
-					categoryMask = categoryMask || tItem->tmplate()->hasCategory( id );
-				}
-			}
-		
-
-			if (  nameMask && sizeMask && categoryMask )
-			{
-				item->setHidden( false );
-			}
-			else
-			{
-				item->setHidden( true );
-				item->setSelected( false );
-			}
-		}
+		mFilterModel->setMask( mSearchIndex.query( searchString,
+		                                           isoMask, usMask, otherMask,
+		                                           anyCategory, categoryIds ) );
 	}
 
 
@@ -105,30 +81,7 @@ namespace glabels
 	///
 	void TemplatePicker::applyFilter( const QStringList& names )
 	{
-		foreach ( QListWidgetItem *item, findItems( "*", Qt::MatchWildcard ) )
-		{
-			TemplatePickerItem *tItem = dynamic_cast<TemplatePickerItem *>(item);
-
-			bool match = false;
-			foreach ( QString name, names )
-			{
-				if ( tItem->tmplate()->name() == name )
-				{
-					match = true;
-					break;
-				}
-			}
-
-			if (  match )
-			{
-				item->setHidden( false );
-			}
-			else
-			{
-				item->setHidden( true );
-				item->setSelected( false );
-			}
-		}
+		mFilterModel->setMask( mSearchIndex.queryNames( names ) );
 	}
 
 
@@ -137,15 +90,15 @@ namespace glabels
 	///
 	const Template *TemplatePicker::selectedTemplate()
 	{
-		QList<QListWidgetItem *> items = selectedItems();
-		if ( items.isEmpty() )
+		QModelIndexList indexes = selectionModel()->selectedIndexes();
+		if ( indexes.isEmpty() )
 		{
 			return nullptr;
 		}
 		else
 		{
-			TemplatePickerItem *tItem = dynamic_cast<TemplatePickerItem*>(items.first());
-			return tItem->tmplate();
+			QModelIndex sourceIndex = mFilterModel->mapToSource( indexes.first() );
+			return mModel->tmplate( sourceIndex.row() );
 		}
 	}
 
@@ -23,18 +23,24 @@
 
 
 #include "Template.h"
+#include "TemplateSearchIndex.h"
 
 #include <QList>
-#include <QListWidget>
+#include <QListView>
 
 
 namespace glabels
 {
 
+	// Forward references
+	class TemplatePickerFilterModel;
+	class TemplatePickerModel;
+
+
 	///
 	/// Template Picker Widget
 	///
-	class TemplatePicker : public QListWidget
+	class TemplatePicker : public QListView
 	{
 		Q_OBJECT
 
@@ -46,6 +52,13 @@ namespace glabels
 		TemplatePicker( QWidget *parent = nullptr );
 
 
+		/////////////////////////////////
+		// Signals
+		/////////////////////////////////
+	signals:
+		void itemSelectionChanged();
+
+
 		/////////////////////////////////
 		// Properties
 		/////////////////////////////////
@@ -64,6 +77,15 @@ namespace glabels
 
 		const Template *selectedTemplate();
 
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		TemplatePickerModel*       mModel;
+		TemplatePickerFilterModel* mFilterModel;
+		TemplateSearchIndex        mSearchIndex;
+
 	};
 
 }
@@ -1,6 +1,6 @@
-/*  TemplatePickerItem.cpp
+/*  TemplatePickerFilterModel.cpp
  *
- *  Copyright (C) 2013  Jim Evins <evins@snaught.com>
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
  *
  *  This file is part of gLabels-qt.
  *
@@ -18,11 +18,7 @@
  *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "TemplatePickerItem.h"
-
-#include <QHBoxLayout>
-#include <QIcon>
-#include <QListWidgetItem>
+#include "TemplatePickerFilterModel.h"
 
 
 namespace glabels
@@ -31,24 +27,32 @@ namespace glabels
 	///
 	/// Constructor
 	///
-	TemplatePickerItem::TemplatePickerItem( Template *tmplate, QListWidget *parent )
-		: QListWidgetItem(parent)
+	TemplatePickerFilterModel::TemplatePickerFilterModel( QObject *parent )
+		: QSortFilterProxyModel(parent)
 	{
-		mTmplate = tmplate;
+		// empty
+	}
 
-		setIcon( QIcon(tmplate->preview()) );
-		setText( tmplate->name() );
 
-		setFlags( Qt::ItemIsSelectable | Qt::ItemIsEnabled );
+	///
+	/// Set Mask of Accepted Rows
+	///
+	void TemplatePickerFilterModel::setMask( const QBitArray &mask )
+	{
+		if ( mask != mMask )
+		{
+			mMask = mask;
+			invalidateFilter();
+		}
 	}
 
 
 	///
-	/// Template Property Getter
+	/// Is Row Accepted?
 	///
-	const Template *TemplatePickerItem::tmplate() const
+	bool TemplatePickerFilterModel::filterAcceptsRow( int sourceRow, const QModelIndex &sourceParent ) const
 	{
-		return mTmplate;
+		return mMask.isEmpty() || ((sourceRow < mMask.size()) && mMask.testBit( sourceRow ));
 	}
 
 } // namespace glabels
@@ -1,6 +1,6 @@
-/*  TemplatePickerItem.h
+/*  TemplatePickerFilterModel.h
  *
- *  Copyright (C) 2013  Jim Evins <evins@snaught.com>
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
  *
  *  This file is part of gLabels-qt.
  *
@@ -18,48 +18,56 @@
  *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#ifndef TemplatePickerItem_h
-#define TemplatePickerItem_h
+#ifndef TemplatePickerFilterModel_h
+#define TemplatePickerFilterModel_h
 
 
-#include "Template.h"
-
-#include <QLabel>
-#include <QListWidget>
+#include <QBitArray>
+#include <QSortFilterProxyModel>
 
 
 namespace glabels
 {
 
 	///
-	/// Template Picker Item Widget
+	/// Template Picker Filter Model
+	///
+	/// Accepts the source rows whose bits are set in a mask, as computed by
+	/// TemplateSearchIndex.  An empty mask accepts every row.
 	///
-	class TemplatePickerItem : public QListWidgetItem
+	class TemplatePickerFilterModel : public QSortFilterProxyModel
 	{
 
 		/////////////////////////////////
 		// Life Cycle
 		/////////////////////////////////
 	public:
-		TemplatePickerItem( Template *tmplate, QListWidget *parent = nullptr );
+		TemplatePickerFilterModel( QObject *parent = nullptr );
 
 
 		/////////////////////////////////
 		// Properties
 		/////////////////////////////////
 	public:
-		const Template *tmplate() const;
+		void setMask( const QBitArray &mask );
+
+
+		/////////////////////////////////
+		// QSortFilterProxyModel implementation
+		/////////////////////////////////
+	protected:
+		bool filterAcceptsRow( int sourceRow, const QModelIndex &sourceParent ) const override;
 
 
 		/////////////////////////////////
-		// Private Data
+		// Private data
 		/////////////////////////////////
 	private:
-		Template *mTmplate;
+		QBitArray mMask;
 
 	};
 
 }
 
 
-#endif // TemplatePickerItem_h
+#endif // TemplatePickerFilterModel_h
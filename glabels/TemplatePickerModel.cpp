@@ -0,0 +1,132 @@
+/*  TemplatePickerModel.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TemplatePickerModel.h"
+
+#include "MiniPreviewCache.h"
+
+
+namespace glabels
+{
+
+	///
+	/// Constructor
+	///
+	TemplatePickerModel::TemplatePickerModel( QObject *parent )
+		: QAbstractListModel(parent)
+	{
+		connect( MiniPreviewCache::instance(), SIGNAL(previewReady(const Template*,const QImage&)),
+		         this, SLOT(onPreviewReady(const Template*,const QImage&)) );
+	}
+
+
+	///
+	/// Set List of Templates
+	///
+	void TemplatePickerModel::setTemplates( const QList<Template*> &tmplates )
+	{
+		beginResetModel();
+
+		mTemplates = tmplates;
+		mPendingRows.clear();
+
+		endResetModel();
+	}
+
+
+	///
+	/// Get Template of Row
+	///
+	const Template *TemplatePickerModel::tmplate( int row ) const
+	{
+		if ( (row < 0) || (row >= mTemplates.size()) )
+		{
+			return nullptr;
+		}
+
+		return mTemplates[row];
+	}
+
+
+	///
+	/// Row Count
+	///
+	int TemplatePickerModel::rowCount( const QModelIndex &parent ) const
+	{
+		return parent.isValid() ? 0 : mTemplates.size();
+	}
+
+
+	///
+	/// Data of Row
+	///
+	QVariant TemplatePickerModel::data( const QModelIndex &index, int role ) const
+	{
+		const Template *tmplate = this->tmplate( index.row() );
+		if ( !index.isValid() || !tmplate )
+		{
+			return QVariant();
+		}
+
+		switch ( role )
+		{
+		case Qt::DisplayRole:
+			return tmplate->name();
+
+		case Qt::DecorationRole:
+			{
+				// Held (and shared between templates of the same geometry) by
+				// the bounded MiniPreviewCache, not copied here.
+				QImage image = MiniPreviewCache::instance()->preview( tmplate );
+				if ( image.isNull() )
+				{
+					// Being rendered, see onPreviewReady()
+					mPendingRows.insert( tmplate, index.row() );
+					return QVariant();
+				}
+
+				return image;
+			}
+
+		default:
+			return QVariant();
+		}
+	}
+
+
+	///
+	/// Preview Rendered in Background
+	///
+	void TemplatePickerModel::onPreviewReady( const Template* tmplate, const QImage& image )
+	{
+		auto it = mPendingRows.find( tmplate );
+		if ( it == mPendingRows.end() )
+		{
+			return;
+		}
+
+		int row = *it;
+		mPendingRows.erase( it );
+
+		QModelIndex rowIndex = index( row );
+		emit dataChanged( rowIndex, rowIndex, QVector<int>() << Qt::DecorationRole );
+	}
+
+} // namespace glabels
@@ -0,0 +1,91 @@
+/*  TemplatePickerModel.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TemplatePickerModel_h
+#define TemplatePickerModel_h
+
+
+#include "Template.h"
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QImage>
+#include <QList>
+
+
+namespace glabels
+{
+
+	///
+	/// Template Picker Model
+	///
+	/// One row per template.  Nothing is created per row up front: preview
+	/// icons are requested from MiniPreviewCache only when a view asks for a
+	/// row's decoration, i.e. when the row is about to be painted.
+	///
+	class TemplatePickerModel : public QAbstractListModel
+	{
+		Q_OBJECT
+
+
+		/////////////////////////////////
+		// Life Cycle
+		/////////////////////////////////
+	public:
+		TemplatePickerModel( QObject *parent = nullptr );
+
+
+		/////////////////////////////////
+		// Properties
+		/////////////////////////////////
+	public:
+		void setTemplates( const QList<Template*> &tmplates );
+		const Template *tmplate( int row ) const;
+
+
+		/////////////////////////////////
+		// QAbstractListModel implementation
+		/////////////////////////////////
+	public:
+		int rowCount( const QModelIndex &parent = QModelIndex() ) const override;
+		QVariant data( const QModelIndex &index, int role = Qt::DisplayRole ) const override;
+
+
+		/////////////////////////////////
+		// Private slots
+		/////////////////////////////////
+	private slots:
+		void onPreviewReady( const Template* tmplate, const QImage& image );
+
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		QList<Template*>                      mTemplates;
+
+		mutable QHash<const Template*,int>     mPendingRows;
+
+	};
+
+}
+
+
+#endif // TemplatePickerModel_h
@@ -0,0 +1,238 @@
+/*  TemplateSearchIndex.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TemplateSearchIndex.h"
+
+#include "Template.h"
+
+
+namespace glabels
+{
+
+	//
+	// Private
+	//
+	namespace
+	{
+		const int maxGramLength = 3;
+	}
+
+
+	///
+	/// Constructor
+	///
+	TemplateSearchIndex::TemplateSearchIndex()
+		: mSize(0)
+	{
+		// empty
+	}
+
+
+	///
+	/// Build index over list of templates, replacing any previous contents
+	///
+	void TemplateSearchIndex::build( const QList<Template*>& tmplates )
+	{
+		mSize = tmplates.size();
+
+		mFoldedNames.clear();
+		mNameIndex.clear();
+		mPostings.clear();
+		mCategories.clear();
+		mLastSearch.clear();
+		mLastMatches.clear();
+
+		mFoldedNames.reserve( mSize );
+		mIso   = QBitArray( mSize );
+		mUs    = QBitArray( mSize );
+		mOther = QBitArray( mSize );
+
+		for ( int id = 0; id < mSize; id++ )
+		{
+			const Template* tmplate = tmplates[id];
+
+			QString name = tmplate->name().toCaseFolded();
+			mFoldedNames << name;
+			if ( !mNameIndex.contains( tmplate->name() ) )
+			{
+				mNameIndex.insert( tmplate->name(), id );
+			}
+
+			// Ids are visited in order, so each posting list stays sorted
+			for ( int i = 0; i < name.size(); i++ )
+			{
+				for ( int n = 1; (n <= maxGramLength) && (i + n <= name.size()); n++ )
+				{
+					QVector<int>& posting = mPostings[ name.mid( i, n ) ];
+					if ( posting.isEmpty() || (posting.last() != id) )
+					{
+						posting << id;
+					}
+				}
+			}
+
+			mIso.setBit( id, tmplate->isSizeIso() );
+			mUs.setBit( id, tmplate->isSizeUs() );
+			mOther.setBit( id, tmplate->isSizeOther() );
+
+			foreach ( QString categoryId, tmplate->categoryIds() )
+			{
+				QBitArray& bits = mCategories[categoryId];
+				if ( bits.isEmpty() )
+				{
+					bits = QBitArray( mSize );
+				}
+				bits.setBit( id );
+			}
+		}
+	}
+
+
+	///
+	/// Query by name substring, paper size class and categories
+	///
+	QBitArray TemplateSearchIndex::query( const QString& searchString,
+	                                      bool isoMask, bool usMask, bool otherMask,
+	                                      bool anyCategory, const QStringList& categoryIds )
+	{
+		QBitArray result( mSize, false );
+
+		if ( searchString.isEmpty() )
+		{
+			result.fill( true );
+		}
+		else
+		{
+			foreach ( int id, nameMatches( searchString ) )
+			{
+				result.setBit( id );
+			}
+		}
+
+		QBitArray sizeBits( mSize, false );
+		if ( isoMask )
+		{
+			sizeBits |= mIso;
+		}
+		if ( usMask )
+		{
+			sizeBits |= mUs;
+		}
+		if ( otherMask )
+		{
+			sizeBits |= mOther;
+		}
+		result &= sizeBits;
+
+		if ( !anyCategory )
+		{
+			QBitArray categoryBits( mSize, false );
+			foreach ( QString categoryId, categoryIds )
+			{
+				if ( mCategories.contains( categoryId ) )
+				{
+					categoryBits |= mCategories[categoryId];
+				}
+			}
+			result &= categoryBits;
+		}
+
+		return result;
+	}
+
+
+	///
+	/// Query by exact names
+	///
+	QBitArray TemplateSearchIndex::queryNames( const QStringList& names ) const
+	{
+		QBitArray result( mSize, false );
+
+		foreach ( QString name, names )
+		{
+			if ( mNameIndex.contains( name ) )
+			{
+				result.setBit( mNameIndex[name] );
+			}
+		}
+
+		return result;
+	}
+
+
+	///
+	/// Ids of templates whose names contain searchString (case insensitive)
+	///
+	const QVector<int>& TemplateSearchIndex::nameMatches( const QString& searchString )
+	{
+		QString search = searchString.toCaseFolded();
+		if ( search == mLastSearch )
+		{
+			return mLastMatches;
+		}
+
+		// Start from the smallest candidate list that must contain all matches:
+		// the rarest gram of the search string, or the previous matches if the
+		// search string extends the previous one.
+		static const QVector<int> none;
+		const QVector<int>* candidates = nullptr;
+
+		int n = qMin( search.size(), maxGramLength );
+		for ( int i = 0; i + n <= search.size(); i++ )
+		{
+			auto it = mPostings.constFind( search.mid( i, n ) );
+			const QVector<int>* posting = (it != mPostings.constEnd()) ? &(*it) : &none;
+
+			if ( !candidates || (posting->size() < candidates->size()) )
+			{
+				candidates = posting;
+			}
+		}
+
+		bool narrowing = !mLastSearch.isEmpty() && search.contains( mLastSearch );
+		if ( narrowing && (mLastMatches.size() < candidates->size()) )
+		{
+			candidates = &mLastMatches;
+		}
+
+		// Grams only guarantee a superset for searches longer than a gram
+		QVector<int> matches;
+		if ( (search.size() <= maxGramLength) && (candidates != &mLastMatches) )
+		{
+			matches = *candidates;
+		}
+		else
+		{
+			foreach ( int id, *candidates )
+			{
+				if ( mFoldedNames[id].contains( search ) )
+				{
+					matches << id;
+				}
+			}
+		}
+
+		mLastSearch  = search;
+		mLastMatches = matches;
+
+		return mLastMatches;
+	}
+
+} // namespace glabels
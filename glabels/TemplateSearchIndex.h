@@ -0,0 +1,109 @@
+/*  TemplateSearchIndex.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TemplateSearchIndex_h
+#define TemplateSearchIndex_h
+
+
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+
+namespace glabels
+{
+
+	// Forward References
+	class Template;
+
+
+	///
+	/// Template Search Index
+	///
+	/// Answers template picker queries over a fixed list of templates.  Each
+	/// query returns a bit array with one bit per template, in list order.
+	///
+	/// Names are indexed by all of their case folded substrings of up to 3
+	/// characters, so a name query only has to verify the templates in its
+	/// rarest posting list.  A query that extends the previous one (the
+	/// usual case while typing) only re-checks the previous matches.  Paper
+	/// size classes and categories are precomputed bit arrays.
+	///
+	class TemplateSearchIndex
+	{
+
+		/////////////////////////////////
+		// Lifecycle
+		/////////////////////////////////
+	public:
+		TemplateSearchIndex();
+
+
+		/////////////////////////////////
+		// Maintenance
+		/////////////////////////////////
+	public:
+		void build( const QList<Template*>& tmplates );
+
+
+		/////////////////////////////////
+		// Queries
+		/////////////////////////////////
+	public:
+		QBitArray query( const QString& searchString,
+		                 bool isoMask, bool usMask, bool otherMask,
+		                 bool anyCategory, const QStringList& categoryIds );
+
+		QBitArray queryNames( const QStringList& names ) const;
+
+
+		/////////////////////////////////
+		// Private methods
+		/////////////////////////////////
+	private:
+		const QVector<int>& nameMatches( const QString& searchString );
+
+
+		/////////////////////////////////
+		// Private data
+		/////////////////////////////////
+	private:
+		int                          mSize;
+
+		QVector<QString>             mFoldedNames;
+		QHash<QString,int>           mNameIndex;
+		QHash<QString,QVector<int>>  mPostings;
+
+		QBitArray                    mIso;
+		QBitArray                    mUs;
+		QBitArray                    mOther;
+		QHash<QString,QBitArray>     mCategories;
+
+		QString                      mLastSearch;
+		QVector<int>                 mLastMatches;
+	};
+
+}
+
+
+#endif // TemplateSearchIndex_h
@@ -21,11 +21,72 @@
 #include "UndoRedoModel.h"
 
 #include "LabelModel.h"
+#include "LabelModelImageObject.h"
+#include "LabelModelObject.h"
+#include "Settings.h"
+#include "XmlLabelCreator.h"
+#include "XmlLabelParser.h"
+
+#include "Merge/Merge.h"
+#include "Merge/Record.h"
+
+#include <QImage>
+#include <QSet>
+#include <QtConcurrent>
+#include <QtDebug>
 
 
 namespace glabels
 {
 
+	//
+	// Private
+	//
+	namespace
+	{
+		// Rough per-object cost (QObject, matrix, properties) not covered below
+		const qint64 objectOverheadBytes = 1024;
+
+
+		qint64 imageCost( const QImage& image )
+		{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+			return image.sizeInBytes();
+#else
+			return image.byteCount();
+#endif
+		}
+
+
+		// Embedded images are accounted for separately, see UndoRedoModel::account()
+		qint64 objectCost( const LabelModelObject* object )
+		{
+			qint64 cost = objectOverheadBytes;
+
+			cost += object->svg().size();
+			cost += object->text().size() * qint64(sizeof(QChar));
+
+			return cost;
+		}
+
+
+		qint64 mergeCost( const merge::Merge* merge )
+		{
+			qint64 cost = objectOverheadBytes;
+
+			foreach ( const merge::Record* record, merge->recordList() )
+			{
+				for ( auto it = record->constBegin(); it != record->constEnd(); ++it )
+				{
+					cost += (it.key().size() + it.value().size()) * qint64(sizeof(QChar));
+				}
+			}
+
+			return cost;
+		}
+	}
+
+
 	///
 	/// Constructor
 	///
@@ -33,8 +94,16 @@ namespace glabels
 	{
 		mModel = model;
 		mNewSelection = true;
+		mMergeDirty = true;
+		mHistoryBytes = 0;
+		mNextSerial = 0;
 
 		connect( model, SIGNAL(selectionChanged()), this, SLOT(onSelectionChanged()) );
+		connect( model, SIGNAL(mergeChanged()), this, SLOT(onMergeChanged()) );
+		connect( model, SIGNAL(mergeSourceChanged()), this, SLOT(onMergeChanged()) );
+		connect( model, SIGNAL(mergeSelectionChanged()), this, SLOT(onMergeChanged()) );
+
+		connect( Settings::instance(), SIGNAL(changed()), this, SLOT(onSettingsChanged()) );
 	}
 
 
@@ -63,16 +132,18 @@ namespace glabels
 		{
 
 			/* Sever old redo "thread" */
-			mRedoStack.clear();
+			clearStack( mRedoStack );
 
 			/* Save state onto undo stack. */
-			State* stateNow = new State( mModel, description );
-			mUndoStack.push( stateNow );
+			State* stateNow = saveState( description );
+			pushState( mUndoStack, stateNow );
 
 			/* Track consecutive checkpoints. */
 			mNewSelection = false;
 			mLastDescription = description;
 
+			enforceBudget();
+
 			emit changed();
 		}
 	}
@@ -83,16 +154,18 @@ namespace glabels
 	///
 	void UndoRedoModel::undo()
 	{
-		State* oldState = mUndoStack.pop();
-		State* stateNow = new State( mModel, oldState->description );
+		State* oldState = popState( mUndoStack );
+		State* stateNow = saveState( oldState->description );
 
-		mRedoStack.push( stateNow );
+		pushState( mRedoStack, stateNow );
 
-		mModel->restore( oldState->model );
-		delete oldState;
+		restoreState( oldState );
+		discardState( oldState );
 	
 		mNewSelection = true;
 
+		enforceBudget();
+
 		emit changed();
 	}
 	
@@ -102,16 +175,18 @@ namespace glabels
 	///
 	void UndoRedoModel::redo()
 	{
-		State* oldState = mRedoStack.pop();
-		State* stateNow = new State( mModel, oldState->description );
+		State* oldState = popState( mRedoStack );
+		State* stateNow = saveState( oldState->description );
 
-		mUndoStack.push( stateNow );
+		pushState( mUndoStack, stateNow );
 
-		mModel->restore( oldState->model );
-		delete oldState;
+		restoreState( oldState );
+		discardState( oldState );
 	
 		mNewSelection = true;
 
+		enforceBudget();
+
 		emit changed();
 	}
 	
@@ -166,6 +241,18 @@ namespace glabels
 	}
 
 	
+	///
+	/// Estimated memory that only the undo/redo history holds on to
+	///
+	/// Clones shared with the live model or with the most recent undo and redo
+	/// states are left out, since trimming the history could not free them.
+	///
+	qint64 UndoRedoModel::memoryUsage() const
+	{
+		return mHistoryBytes;
+	}
+
+
 	///
 	/// Selection changed handler
 	///
@@ -175,13 +262,554 @@ namespace glabels
 	}
 
 
+	///
+	/// Merge changed handler
+	///
+	void UndoRedoModel::onMergeChanged()
+	{
+		mMergeDirty = true;
+	}
+
+
+	///
+	/// Settings changed handler
+	///
+	void UndoRedoModel::onSettingsChanged()
+	{
+		enforceBudget();
+	}
+
+
+	///
+	/// Background compression finished handler
+	///
+	void UndoRedoModel::onCompressionFinished()
+	{
+		QFutureWatcher<QByteArray>* watcher = static_cast<QFutureWatcher<QByteArray>*>( sender() );
+		CompressionJob job = mCompressionJobs.take( watcher );
+		watcher->deleteLater();
+
+		// State may have been popped or discarded while we were busy
+		State* state = findState( job.serial );
+		if ( state == nullptr )
+		{
+			return;
+		}
+
+		state->compressing = false;
+
+		// ... or have become the next state to undo or redo
+		if ( isHot( state ) )
+		{
+			return;
+		}
+
+		QByteArray compressedObjects = watcher->result();
+		if ( compressedObjects.isEmpty() )
+		{
+			qWarning() << "Undo state compression failed, keeping state uncompressed.";
+			return;
+		}
+
+		QSet<const LabelModelObject*> compressed;
+		foreach ( const QSharedPointer<LabelModelObject>& object, job.objects )
+		{
+			compressed.insert( object.data() );
+		}
+
+		for ( int i = 0; i < state->objects.size(); i++ )
+		{
+			if ( compressed.contains( state->objects[i].data() ) )
+			{
+				state->compressedIds << state->objects[i]->id();
+				state->compressedSelection << state->objects[i]->isSelected();
+
+				account( state->objects[i].data(), -1, 0 );
+				state->objects[i].clear();
+			}
+		}
+
+		state->compressedObjects = compressedObjects;
+		mHistoryBytes += compressedObjects.size();
+
+		enforceBudget();
+	}
+
+
+	///
+	/// Save current model state, reusing saved clones of unchanged objects
+	///
+	UndoRedoModel::State* UndoRedoModel::saveState( const QString& description )
+	{
+		State* state = new State( description );
+		state->serial = mNextSerial++;
+
+		state->properties = mModel->saveProperties();
+
+		QHash<LabelModelObject*,CachedObject> objectCache;
+		foreach ( LabelModelObject* object, mModel->objectList() )
+		{
+			// Selection is saved too, but does not count as a revision
+			CachedObject cached = mObjectCache.value( object );
+			if ( !cached.clone || (cached.revision != object->revision()) ||
+			     (cached.clone->isSelected() != object->isSelected()) )
+			{
+				cached.revision = object->revision();
+				cached.clone    = QSharedPointer<LabelModelObject>( object->clone() );
+			}
+
+			objectCache.insert( object, cached );
+			state->objects << cached.clone;
+		}
+
+		QSharedPointer<merge::Merge> mergeCache = mMergeCache;
+		if ( mMergeDirty || !mMergeCache )
+		{
+			mergeCache = QSharedPointer<merge::Merge>( mModel->merge()->clone() );
+			mMergeDirty = false;
+		}
+		state->merge = mergeCache;
+
+		setLive( objectCache, mergeCache );
+
+		return state;
+	}
+
+
+	///
+	/// Restore model to saved state
+	///
+	void UndoRedoModel::restoreState( State* state )
+	{
+		decompressState( state );
+
+		QList<LabelModelObject*> savedObjects;
+		foreach ( const QSharedPointer<LabelModelObject>& savedObject, state->objects )
+		{
+			savedObjects << savedObject.data();
+		}
+
+		mModel->restore( state->properties, savedObjects, state->merge.data() );
+
+		// Live objects are now fresh clones of the saved ones, so the saved ones
+		// can be reused by the next checkpoint.
+		QHash<LabelModelObject*,CachedObject> objectCache;
+		const QList<LabelModelObject*>& objects = mModel->objectList();
+		for ( int i = 0; i < objects.size() && i < state->objects.size(); i++ )
+		{
+			CachedObject cached;
+			cached.revision = objects[i]->revision();
+			cached.clone    = state->objects[i];
+			objectCache.insert( objects[i], cached );
+		}
+
+		setLive( objectCache, state->merge );
+		mMergeDirty = false;
+	}
+
+
+	///
+	/// Replace the clones that back the live model
+	///
+	void UndoRedoModel::setLive( const QHash<LabelModelObject*,CachedObject>& objectCache,
+	                             const QSharedPointer<merge::Merge>& mergeCache )
+	{
+		// Pin the new ones first, so that clones in both keep their entries
+		foreach ( const CachedObject& cached, objectCache )
+		{
+			account( cached.clone.data(), 0, 1 );
+		}
+		if ( mergeCache )
+		{
+			account( mergeCache.data(), 0, 1 );
+		}
+
+		foreach ( const CachedObject& cached, mObjectCache )
+		{
+			account( cached.clone.data(), 0, -1 );
+		}
+		if ( mMergeCache )
+		{
+			account( mMergeCache.data(), 0, -1 );
+		}
+
+		mObjectCache = objectCache;
+		mMergeCache  = mergeCache;
+	}
+
+
+	///
+	/// Push state onto stack, making it the hot one
+	///
+	void UndoRedoModel::pushState( Stack& stack, State* state )
+	{
+		mHistoryBytes += objectOverheadBytes + state->compressedObjects.size();
+		account( state, 1, 0 );
+
+		if ( !stack.isEmpty() )
+		{
+			account( stack.at( 0 ), 0, -1 );
+		}
+		stack.push( state );
+		account( state, 0, 1 );
+	}
+
+
+	///
+	/// Pop hot state from stack, the state is still accounted for until discarded
+	///
+	UndoRedoModel::State* UndoRedoModel::popState( Stack& stack )
+	{
+		State* state = stack.pop();
+		account( state, 0, -1 );
+
+		if ( !stack.isEmpty() )
+		{
+			account( stack.at( 0 ), 0, 1 );
+		}
+
+		return state;
+	}
+
+
+	///
+	/// Discard all states of stack
+	///
+	void UndoRedoModel::clearStack( Stack& stack )
+	{
+		while ( !stack.isEmpty() )
+		{
+			discardState( popState( stack ) );
+		}
+	}
+
+
+	///
+	/// Delete state that is no longer on either stack
+	///
+	void UndoRedoModel::discardState( State* state )
+	{
+		account( state, -1, 0 );
+		mHistoryBytes -= objectOverheadBytes + state->compressedObjects.size();
+
+		delete state;
+	}
+
+
+	///
+	/// Is state the next one to undo or redo?
+	///
+	bool UndoRedoModel::isHot( const State* state ) const
+	{
+		return (!mUndoStack.isEmpty() && (mUndoStack.at( 0 ) == state)) ||
+		       (!mRedoStack.isEmpty() && (mRedoStack.at( 0 ) == state));
+	}
+
+
+	///
+	/// Account for the clones and merge of a state
+	///
+	void UndoRedoModel::account( const State* state, int refs, int pins )
+	{
+		foreach ( const QSharedPointer<LabelModelObject>& object, state->objects )
+		{
+			if ( object )
+			{
+				account( object.data(), refs, pins );
+			}
+		}
+
+		if ( state->merge )
+		{
+			account( state->merge.data(), refs, pins );
+		}
+	}
+
+
+	///
+	/// Account for a clone
+	///
+	/// Embedded images are implicitly shared between a live object and all its
+	/// clones, so their payloads are separate entries held by each clone.
+	///
+	void UndoRedoModel::account( const LabelModelObject* object, int refs, int pins )
+	{
+		if ( !mUsage.contains( object ) )
+		{
+			Usage usage = { 0, 0, objectCost( object ), QList<const void*>() };
+
+			if ( const LabelModelImageObject* imageObject = dynamic_cast<const LabelModelImageObject*>( object ) )
+			{
+				// Weigh embedded images without forcing them to be decoded
+				QByteArray imageData = imageObject->imageData();
+				if ( !imageData.isEmpty() && !mUsage.contains( imageData.constData() ) )
+				{
+					Usage part = { 0, 0, imageData.size(), QList<const void*>() };
+					mUsage.insert( imageData.constData(), part );
+				}
+				if ( !imageData.isEmpty() )
+				{
+					usage.parts << imageData.constData();
+				}
+
+				const QImage* image = imageObject->isImageDecoded() ? imageObject->image() : nullptr;
+				if ( image && !image->isNull() && !mUsage.contains( image->constBits() ) )
+				{
+					Usage part = { 0, 0, imageCost( *image ), QList<const void*>() };
+					mUsage.insert( image->constBits(), part );
+				}
+				if ( image && !image->isNull() )
+				{
+					usage.parts << image->constBits();
+				}
+			}
+
+			mUsage.insert( object, usage );
+		}
+
+		adjust( object, refs, pins );
+	}
+
+
+	///
+	/// Account for a merge
+	///
+	void UndoRedoModel::account( const merge::Merge* merge, int refs, int pins )
+	{
+		if ( !mUsage.contains( merge ) )
+		{
+			Usage usage = { 0, 0, mergeCost( merge ), QList<const void*>() };
+			mUsage.insert( merge, usage );
+		}
+
+		adjust( merge, refs, pins );
+	}
+
+
+	///
+	/// Adjust references and pins of an entry, keeping mHistoryBytes up to date
+	///
+	void UndoRedoModel::adjust( const void* key, int refs, int pins )
+	{
+		Usage& usage = mUsage[key];
+
+		bool wasHeld    = (usage.refs > 0) || (usage.pins > 0);
+		bool wasPinned  = usage.pins > 0;
+		bool wasCounted = (usage.refs > 0) && !wasPinned;
+
+		usage.refs += refs;
+		usage.pins += pins;
+
+		bool isHeld    = (usage.refs > 0) || (usage.pins > 0);
+		bool isPinned  = usage.pins > 0;
+		bool isCounted = (usage.refs > 0) && !isPinned;
+
+		if ( isCounted != wasCounted )
+		{
+			mHistoryBytes += isCounted ? usage.cost : -usage.cost;
+		}
+
+		// Each held clone holds its payloads once, each pinned clone pins them
+		QList<const void*> parts = usage.parts;
+		if ( !isHeld )
+		{
+			mUsage.remove( key );
+		}
+
+		int partRefs = int(isHeld) - int(wasHeld);
+		int partPins = int(isPinned) - int(wasPinned);
+		if ( partRefs || partPins )
+		{
+			foreach ( const void* part, parts )
+			{
+				adjust( part, partRefs, partPins );
+			}
+		}
+	}
+
+
+	///
+	/// Would compressing this clone away actually free it?
+	///
+	bool UndoRedoModel::isHistoryOnly( const LabelModelObject* object ) const
+	{
+		Usage usage = mUsage.value( object );
+		if ( usage.pins > 0 )
+		{
+			return false;
+		}
+
+		// Serializing a payload that stays in memory anyway would only add to it
+		foreach ( const void* part, usage.parts )
+		{
+			if ( mUsage.value( part ).pins > 0 )
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	///
+	/// Keep history within memory budget
+	///
+	/// First moves the objects of old states into compressed form, oldest first,
+	/// then, if that is not enough, discards the oldest undo states entirely.
+	/// The most recent undo and redo states are always kept hot, so that a single
+	/// undo or redo never has to wait for decompression.
+	///
+	void UndoRedoModel::enforceBudget()
+	{
+		qint64 budget = Settings::undoMemoryBudget();
+		if ( (budget <= 0) || (mHistoryBytes <= budget) )
+		{
+			return;
+		}
+
+		QList<Stack*> stacks;
+		stacks << &mRedoStack << &mUndoStack;
+		foreach ( Stack* stack, stacks )
+		{
+			for ( int i = stack->size()-1; i > 0; i-- )
+			{
+				State* state = stack->at( i );
+				if ( !state->isCold() && !state->compressing )
+				{
+					compressState( state );
+				}
+			}
+		}
+
+		// Compression is asynchronous, so only count what has already landed
+		while ( (mHistoryBytes > budget) && (mUndoStack.size() > 1) && !mUndoStack.at( mUndoStack.size()-1 )->compressing )
+		{
+			discardState( mUndoStack.takeOldest() );
+		}
+	}
+
+
+	///
+	/// Start compressing the objects of a state in the background
+	///
+	/// Only clones held by history alone are compressed, the others would stay
+	/// in memory regardless.
+	///
+	void UndoRedoModel::compressState( State* state )
+	{
+		CompressionJob job;
+		job.serial = state->serial;
+		foreach ( const QSharedPointer<LabelModelObject>& object, state->objects )
+		{
+			if ( isHistoryOnly( object.data() ) )
+			{
+				job.objects << object;
+			}
+		}
+
+		if ( job.objects.isEmpty() )
+		{
+			return;
+		}
+
+		state->compressing = true;
+
+		QFutureWatcher<QByteArray>* watcher = new QFutureWatcher<QByteArray>( this );
+		mCompressionJobs.insert( watcher, job );
+		connect( watcher, SIGNAL(finished()), this, SLOT(onCompressionFinished()) );
+
+		// Job holds its own references to the (immutable) clones
+		watcher->setFuture( QtConcurrent::run( &UndoRedoModel::compressObjects, job.objects ) );
+	}
+
+
+	///
+	/// Bring a compressed state back to life
+	///
+	void UndoRedoModel::decompressState( State* state )
+	{
+		if ( !state->isCold() )
+		{
+			return;
+		}
+
+		QList<LabelModelObject*> objects =
+			XmlLabelParser::deserializeObjects( qUncompress( state->compressedObjects ) );
+
+		// Fill the slots that were compressed away, in order, as the same objects
+		for ( int i = 0, j = 0; (i < state->objects.size()) && !objects.isEmpty(); i++ )
+		{
+			if ( !state->objects[i] )
+			{
+				LabelModelObject* object = objects.takeFirst();
+				if ( j < state->compressedIds.size() )
+				{
+					object->setId( state->compressedIds[j] );
+					object->select( state->compressedSelection[j] );
+				}
+				j++;
+
+				state->objects[i] = QSharedPointer<LabelModelObject>( object );
+				account( object, 1, 0 );
+			}
+		}
+		qDeleteAll( objects );
+
+		mHistoryBytes -= state->compressedObjects.size();
+		state->compressedObjects.clear();
+		state->compressedIds.clear();
+		state->compressedSelection.clear();
+	}
+
+
+	///
+	/// Find state by serial number
+	///
+	UndoRedoModel::State* UndoRedoModel::findState( quint64 serial ) const
+	{
+		QList<const Stack*> stacks;
+		stacks << &mUndoStack << &mRedoStack;
+		foreach ( const Stack* stack, stacks )
+		{
+			for ( int i = 0; i < stack->size(); i++ )
+			{
+				if ( stack->at( i )->serial == serial )
+				{
+					return stack->at( i );
+				}
+			}
+		}
+
+		return nullptr;
+	}
+
+
+	///
+	/// Serialize and compress objects (runs in worker thread)
+	///
+	QByteArray UndoRedoModel::compressObjects( const QList<QSharedPointer<LabelModelObject>>& objects )
+	{
+		QList<LabelModelObject*> list;
+		foreach ( const QSharedPointer<LabelModelObject>& object, objects )
+		{
+			list << object.data();
+		}
+
+		QByteArray buffer;
+		XmlLabelCreator::serializeObjects( list, buffer );
+
+		return qCompress( buffer );
+	}
+
+
 	///
 	/// State constructor
 	///
-	UndoRedoModel::State::State( LabelModel* model, const QString& description )
+	UndoRedoModel::State::State( const QString& description )
+		: serial(0), description(description), properties(nullptr), compressing(false)
 	{
-		this->model = model->save();
-		this->description = description;
+		// empty
 	}
 
 
@@ -190,7 +818,16 @@ namespace glabels
 	///
 	UndoRedoModel::State::~State()
 	{
-		delete model;
+		delete properties;
+	}
+
+
+	///
+	/// Is state compressed?
+	///
+	bool UndoRedoModel::State::isCold() const
+	{
+		return !compressedObjects.isEmpty();
 	}
 
 
@@ -230,6 +867,15 @@ namespace glabels
 	}
 
 
+	///
+	/// Take state from bottom of stack
+	///
+	UndoRedoModel::State* UndoRedoModel::Stack::takeOldest()
+	{
+		return list.takeLast();
+	}
+
+
 	///
 	/// Peek at state at top of stack
 	///
@@ -248,6 +894,24 @@ namespace glabels
 	}
 
 
+	///
+	/// Number of states on stack
+	///
+	int UndoRedoModel::Stack::size() const
+	{
+		return list.size();
+	}
+
+
+	///
+	/// Get state at position i (0 = top of stack)
+	///
+	UndoRedoModel::State* UndoRedoModel::Stack::at( int i ) const
+	{
+		return list.at( i );
+	}
+
+
 	///
 	/// Clear stack
 	///
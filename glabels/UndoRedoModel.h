@@ -22,8 +22,12 @@
 #define UndoRedoModel_h
 
 
+#include <QByteArray>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QList>
 #include <QObject>
+#include <QSharedPointer>
 #include <QString>
 
 
@@ -32,6 +36,12 @@ namespace glabels
 
 	// Forward references
 	class LabelModel;
+	class LabelModelObject;
+
+	namespace merge
+	{
+		class Merge;
+	}
 
 
 	///
@@ -61,6 +71,7 @@ namespace glabels
 		bool canRedo() const;
 		QString undoDescription() const;
 		QString redoDescription() const;
+		qint64 memoryUsage() const;
 
 
 		/////////////////////////////////
@@ -68,6 +79,9 @@ namespace glabels
 		/////////////////////////////////
 	private slots:
 		void onSelectionChanged();
+		void onMergeChanged();
+		void onSettingsChanged();
+		void onCompressionFinished();
 		
 
 		/////////////////////////////////
@@ -81,14 +95,61 @@ namespace glabels
 		// Private types
 		/////////////////////////////////
 	private:
+		///
+		/// Saved model state
+		///
+		/// Objects and merge are immutable clones shared between states, so a
+		/// checkpoint only costs new clones of whatever changed since the last one.
+		/// When the history is over budget, the objects of old states that are held
+		/// by history alone are replaced by a compressed serialization ("cold"
+		/// state) until they are needed again.  Their slots in objects are left
+		/// null, in the order they appear in compressedObjects.  Serialization
+		/// does not carry ids and selection, so these are kept alongside.
+		///
 		class State
 		{
 		public:
-			State( LabelModel* model, const QString& description );
+			State( const QString& description );
 			~State();
 
-			LabelModel* model;
-			QString     description;
+			bool isCold() const;
+
+			quint64                                  serial;
+			QString                                  description;
+			LabelModel*                              properties;
+			QList<QSharedPointer<LabelModelObject>>  objects;
+			QSharedPointer<merge::Merge>             merge;
+			QByteArray                               compressedObjects;
+			QList<int>                               compressedIds;
+			QList<bool>                              compressedSelection;
+			bool                                     compressing;
+		};
+
+		struct CachedObject
+		{
+			quint64                           revision;
+			QSharedPointer<LabelModelObject>  clone;
+		};
+
+		///
+		/// Memory held by a clone, merge or embedded image payload
+		///
+		/// refs counts the states (or, for a payload, the clones) holding it, pins
+		/// counts those that are hot or live.  Only unpinned memory is counted in
+		/// mHistoryBytes, since dropping history cannot free anything else.
+		///
+		struct Usage
+		{
+			int                 refs;
+			int                 pins;
+			qint64              cost;
+			QList<const void*>  parts;
+		};
+
+		struct CompressionJob
+		{
+			quint64                                  serial;
+			QList<QSharedPointer<LabelModelObject>>  objects;
 		};
 
 		class Stack
@@ -99,8 +160,11 @@ namespace glabels
 
 			void push( State* state );
 			State* pop();
+			State* takeOldest();
 			const State* topState() const;
 			bool isEmpty() const;
+			int size() const;
+			State* at( int i ) const;
 			void clear();
 
 		private:
@@ -108,6 +172,31 @@ namespace glabels
 		};
 	
 
+		/////////////////////////////////
+		// Private methods
+		/////////////////////////////////
+	private:
+		State* saveState( const QString& description );
+		void restoreState( State* state );
+		void setLive( const QHash<LabelModelObject*,CachedObject>& objectCache,
+		              const QSharedPointer<merge::Merge>& mergeCache );
+		void pushState( Stack& stack, State* state );
+		State* popState( Stack& stack );
+		void clearStack( Stack& stack );
+		void discardState( State* state );
+		bool isHot( const State* state ) const;
+		void account( const State* state, int refs, int pins );
+		void account( const LabelModelObject* object, int refs, int pins );
+		void account( const merge::Merge* merge, int refs, int pins );
+		void adjust( const void* key, int refs, int pins );
+		bool isHistoryOnly( const LabelModelObject* object ) const;
+		void enforceBudget();
+		void compressState( State* state );
+		void decompressState( State* state );
+		State* findState( quint64 serial ) const;
+		static QByteArray compressObjects( const QList<QSharedPointer<LabelModelObject>>& objects );
+
+
 		/////////////////////////////////
 		// Private data
 		/////////////////////////////////
@@ -120,6 +209,16 @@ namespace glabels
 		bool                mNewSelection;
 		QString             mLastDescription;
 
+		QHash<LabelModelObject*,CachedObject> mObjectCache;
+		QSharedPointer<merge::Merge>          mMergeCache;
+		bool                                  mMergeDirty;
+
+		QHash<const void*,Usage>              mUsage;
+		qint64                                mHistoryBytes;
+
+		quint64                                            mNextSerial;
+		QHash<QFutureWatcher<QByteArray>*,CompressionJob>  mCompressionJobs;
+
 	};
 
 }
@@ -30,6 +30,7 @@
 #include "LabelModelImageObject.h"
 #include "LabelModelTextObject.h"
 #include "DataCache.h"
+#include "GzipDevice.h"
 #include "XmlTemplateCreator.h"
 #include "XmlUtil.h"
 
@@ -37,6 +38,7 @@
 
 #include <QByteArray>
 #include <QFile>
+#include <QSaveFile>
 #include <QTextBlock>
 #include <QTextDocument>
 #include <QBuffer>
@@ -46,39 +48,65 @@
 namespace glabels
 {
 
-	void
+	bool
 	XmlLabelCreator::writeFile( const LabelModel* label, const QString& fileName )
 	{
-		QDomDocument doc;
+		// Written to a temporary file, which replaces fileName only once complete
+		QSaveFile file( fileName );
+
+		if ( !file.open( QFile::WriteOnly ) )
+		{
+			qWarning() << "Error: Cannot write file " << fileName
+			           << ": " << file.errorString();
+			return false;
+		}
+
+		// Compression level 0 means plain XML, like glabels 3
+		int level = qBound( 0, label->compressionLevel(), 9 );
+		GzipDevice gzipDevice( &file, level );
 
-		createDoc( doc, label );
-		QByteArray buffer = doc.toByteArray( 2 );
+		QIODevice* device = &file;
+		if ( level > 0 )
+		{
+			gzipDevice.open( QIODevice::WriteOnly );
+			device = &gzipDevice;
+		}
 
-		QFile file( fileName );
+		bool ok = writeStream( label, device );
+		gzipDevice.close();
 
-		if ( !file.open( QFile::WriteOnly | QFile::Text) )
+		if ( !ok || (file.error() != QFile::NoError) )
+		{
+			file.cancelWriting();
+		}
+
+		if ( !file.commit() )
 		{
 			qWarning() << "Error: Cannot write file " << fileName
 			           << ": " << file.errorString();
+			return false;
 		}
 
-		file.write( buffer.data(), buffer.size() );
+		return true;
 	}
 
 
 	void
 	XmlLabelCreator::writeBuffer( const LabelModel* label, QByteArray& buffer )
 	{
-		QDomDocument doc;
+		buffer.clear();
 
-		createDoc( doc, label );
-		buffer = doc.toByteArray( 2 );
+		QBuffer device( &buffer );
+		device.open( QIODevice::WriteOnly );
+
+		writeStream( label, &device );
 	}
 
 
 	void
 	XmlLabelCreator::serializeObjects( const QList<LabelModelObject*>& objects,
-	                                   QByteArray&                     buffer )
+	                                   QByteArray&                     buffer,
+	                                   bool                            withData )
 	{
 		QDomDocument doc;
 
@@ -89,22 +117,34 @@ namespace glabels
 		doc.appendChild( root );
 		XmlUtil::setStringAttr( root, "version", "4.0" );
 
-		createDataNode( root, objects );
+		if ( withData )
+		{
+			createDataNode( root, objects );
+		}
 		createObjectsNode( root, objects, false );
 
 		buffer = doc.toByteArray( 2 );
 	}
 
 
-	void
-	XmlLabelCreator::createDoc( QDomDocument& doc, const LabelModel* label )
+	///
+	/// Write document incrementally.  Template, objects and merge are small, so
+	/// they are still built as DOM fragments by the create*Node() methods; the
+	/// bulky embedded data is encoded and written one file at a time.
+	///
+	bool
+	XmlLabelCreator::writeStream( const LabelModel* label, QIODevice* device )
 	{
-		QDomNode xmlNode( doc.createProcessingInstruction( "xml", "version=\"1.0\"" ) );
-		doc.appendChild( xmlNode );
+		QXmlStreamWriter writer( device );
+		writer.setAutoFormatting( true );
+		writer.setAutoFormattingIndent( 2 );
 
-		QDomElement root = doc.createElement( "Glabels-document" );
-		doc.appendChild( root );
-		XmlUtil::setStringAttr( root, "version", "4.0" );
+		writer.writeStartDocument( "1.0" );
+		writer.writeStartElement( "Glabels-document" );
+		writer.writeAttribute( "version", "4.0" );
+
+		QDomDocument doc;
+		QDomElement  root = doc.createElement( "Glabels-document" );
 
 		XmlTemplateCreator().createTemplateNode( root, label->tmplate() );
 
@@ -115,7 +155,100 @@ namespace glabels
 			createMergeNode( root, label );
 		}
 
-		createDataNode( root, label->objectList() );
+		for ( QDomElement child = root.firstChildElement(); !child.isNull(); child = child.nextSiblingElement() )
+		{
+			writeElement( writer, child );
+		}
+
+		writeDataStream( writer, label->objectList() );
+
+		writer.writeEndElement();
+		writer.writeEndDocument();
+
+		return !writer.hasError();
+	}
+
+
+	void
+	XmlLabelCreator::writeElement( QXmlStreamWriter& writer, const QDomElement& element )
+	{
+		writer.writeStartElement( element.tagName() );
+
+		QDomNamedNodeMap attributes = element.attributes();
+		for ( int i = 0; i < attributes.count(); i++ )
+		{
+			QDomAttr attribute = attributes.item( i ).toAttr();
+			writer.writeAttribute( attribute.name(), attribute.value() );
+		}
+
+		for ( QDomNode child = element.firstChild(); !child.isNull(); child = child.nextSibling() )
+		{
+			if ( child.isElement() )
+			{
+				writeElement( writer, child.toElement() );
+			}
+			else if ( child.isCDATASection() )
+			{
+				writer.writeCDATA( child.toCDATASection().data() );
+			}
+			else if ( child.isText() )
+			{
+				writer.writeCharacters( child.toText().data() );
+			}
+			else if ( child.isComment() )
+			{
+				writer.writeComment( child.toComment().data() );
+			}
+		}
+
+		writer.writeEndElement();
+	}
+
+
+	void
+	XmlLabelCreator::writeDataStream( QXmlStreamWriter& writer, const QList<LabelModelObject*>& objects )
+	{
+		writer.writeStartElement( "Data" );
+
+		DataCache data( objects );
+
+		foreach ( QString name, data.imageNames() )
+		{
+			writer.writeStartElement( "File" );
+			writer.writeAttribute( "name", name );
+			writer.writeAttribute( "mimetype", "image/png" );
+			writer.writeAttribute( "encoding", "base64" );
+			writer.writeCharacters( QString::fromLatin1( encodePng( data, name ).toBase64() ) );
+			writer.writeEndElement();
+		}
+
+		foreach ( QString name, data.svgNames() )
+		{
+			writer.writeStartElement( "File" );
+			writer.writeAttribute( "name", name );
+			writer.writeAttribute( "mimetype", "image/svg+xml" );
+			writer.writeAttribute( "encoding", "cdata" );
+			writer.writeCDATA( QString( data.getSvg( name ) ) );
+			writer.writeEndElement();
+		}
+
+		writer.writeEndElement();
+	}
+
+
+	QByteArray
+	XmlLabelCreator::encodePng( const DataCache& data, const QString& name )
+	{
+		// Embedded images that were never decoded are written back as they were read
+		QByteArray ba = data.getImageData( name );
+		if ( ba.isEmpty() )
+		{
+			QBuffer buffer(&ba);
+			buffer.open(QIODevice::WriteOnly);
+			data.getImage( name ).save(&buffer, "PNG");
+		}
+
+		return ba;
 	}
 
 
@@ -445,7 +578,7 @@ namespace glabels
 
 		foreach ( QString name, data.imageNames() )
 		{
-			createPngFileNode( node, name, data.getImage( name ) );
+			createPngFileNode( node, name, encodePng( data, name ) );
 		}
 
 		foreach ( QString name, data.svgNames() )
@@ -456,7 +589,7 @@ namespace glabels
 
 
 	void
-	XmlLabelCreator::createPngFileNode( QDomElement &parent, const QString& name, const QImage& image )
+	XmlLabelCreator::createPngFileNode( QDomElement &parent, const QString& name, const QByteArray& png )
 	{
 		QDomDocument doc = parent.ownerDocument();
 		QDomElement node = doc.createElement( "File" );
@@ -466,11 +599,7 @@ namespace glabels
 		XmlUtil::setStringAttr( node, "mimetype", "image/png" );
 		XmlUtil::setStringAttr( node, "encoding", "base64" );
 
-		QByteArray ba;
-		QBuffer buffer(&ba);
-		buffer.open(QIODevice::WriteOnly);
-		image.save(&buffer, "PNG");
-		QByteArray ba64 = ba.toBase64();
+		QByteArray ba64 = png.toBase64();
 
 		node.appendChild( doc.createTextNode( QString( ba64 ) ) );
 	}
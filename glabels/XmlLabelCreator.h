@@ -24,6 +24,7 @@
 
 #include <QObject>
 #include <QDomElement>
+#include <QXmlStreamWriter>
 
 
 namespace glabels
@@ -38,6 +39,7 @@ namespace glabels
 	class LabelModelImageObject;
 	class LabelModelBarcodeObject;
 	class LabelModelTextObject;
+	class DataCache;
 
 
 	///
@@ -48,12 +50,16 @@ namespace glabels
 		Q_OBJECT
 
 	public:
-		static void writeFile( const LabelModel* label, const QString& fileName );
+		static bool writeFile( const LabelModel* label, const QString& fileName );
 		static void writeBuffer( const LabelModel* label, QByteArray& buffer );
-		static void serializeObjects( const QList<LabelModelObject*>& objects, QByteArray& buffer );
+		static void serializeObjects( const QList<LabelModelObject*>& objects, QByteArray& buffer,
+		                              bool withData = true );
 
 	private:
-		static void createDoc( QDomDocument& doc, const LabelModel* label );
+		static bool writeStream( const LabelModel* label, QIODevice* device );
+		static void writeElement( QXmlStreamWriter& writer, const QDomElement& element );
+		static void writeDataStream( QXmlStreamWriter& writer, const QList<LabelModelObject*>& objects );
+		static QByteArray encodePng( const DataCache& data, const QString& name );
 		static void createRootNode( const LabelModel* label );
 		static void createObjectsNode( QDomElement &parent, const QList<LabelModelObject*>& objects, bool rotate );
 		static void createObjectBoxNode( QDomElement &parent, const LabelModelBoxObject* object );
@@ -71,7 +77,7 @@ namespace glabels
 		static void createShadowAttrs( QDomElement &node, const LabelModelObject* object );
 		static void createMergeNode( QDomElement &parent, const LabelModel* label );
 		static void createDataNode( QDomElement &parent, const QList<LabelModelObject*>& objects );
-		static void createPngFileNode( QDomElement &parent, const QString& name, const QImage& image );
+		static void createPngFileNode( QDomElement &parent, const QString& name, const QByteArray& png );
 		static void createSvgFileNode( QDomElement &parent, const QString& name, const QByteArray& svg );
 
 	};
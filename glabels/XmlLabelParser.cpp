@@ -21,6 +21,7 @@
 #include "XmlLabelParser.h"
 
 #include "EnumUtil.h"
+#include "GzipDevice.h"
 #include "LabelModel.h"
 #include "LabelModelObject.h"
 //#include "LabelModelBarcodeObject.h"
@@ -37,6 +38,7 @@
 
 #include <QByteArray>
 #include <QFile>
+#include <QMap>
 #include <QTextCursor>
 #include <QTextDocument>
 #include <QtDebug>
@@ -47,6 +49,11 @@
 namespace glabels
 {
 
+	///
+	/// Read label from file, streaming it through the parser.  Embedded data
+	/// is decoded as it is encountered and only one element at a time is
+	/// held in DOM form, so peak memory stays close to that of the final model.
+	///
 	LabelModel*
 	XmlLabelParser::readFile( const QString& fileName )
 	{
@@ -59,6 +66,53 @@ namespace glabels
 			return nullptr;
 		}
 
+		GzipDevice gzipDevice( &file );
+		QIODevice* device = &file;
+
+		QByteArray magic = file.peek( 2 );
+		if ( (magic.size() == 2) && ((magic[0]&0xFF) == 0x1F) && ((magic[1]&0xFF) == 0x8b) ) // gzip magic number 0x1F, 0x8B
+		{
+			// gzip compressed format
+			if ( !gzipDevice.open( QIODevice::ReadOnly ) )
+			{
+				qWarning() << "Error: Cannot read file " << qPrintable(fileName)
+				           << ": " << gzipDevice.errorString();
+				return nullptr;
+			}
+			device = &gzipDevice;
+		}
+
+		QXmlStreamReader reader( device );
+		LabelModel* label = parseRootStream( reader );
+
+		// Save it back the way we found it
+		if ( label )
+		{
+			label->setCompressionLevel( (device == &gzipDevice) ? 9 : 0 );
+		}
+
+		return label;
+	}
+
+
+	///
+	/// Read label from file, building a complete DOM tree first
+	///
+	/// This is how files were read before readFile() streamed them.  It is
+	/// only kept so that benchmarks/LabelLoadBenchmark can compare the two.
+	///
+	LabelModel*
+	XmlLabelParser::readFileDom( const QString& fileName )
+	{
+		QFile file( fileName );
+
+		if ( !file.open( QFile::ReadOnly ) )
+		{
+			qWarning() << "Error: Cannot read file " << qPrintable(fileName)
+			           << ": " << file.errorString();
+			return nullptr;
+		}
+
 		QDomDocument doc;
 		bool         success;
 		QString      errorString;
@@ -95,7 +149,13 @@ namespace glabels
 			return nullptr;
 		}
 
-		return parseRootNode( root );
+		LabelModel* label = parseRootNode( root );
+		if ( label )
+		{
+			label->setCompressionLevel( ((rawData[0]&0xFF) == 0x1F) ? 9 : 0 );
+		}
+
+		return label;
 	}
 
 
@@ -128,6 +188,16 @@ namespace glabels
 
 	QList<LabelModelObject*>
 	XmlLabelParser::deserializeObjects( const QByteArray& buffer )
+	{
+		return deserializeObjects( buffer, DataCache() );
+	}
+
+
+	///
+	/// Deserialize objects, whose embedded data may have been stored separately
+	///
+	QList<LabelModelObject*>
+	XmlLabelParser::deserializeObjects( const QByteArray& buffer, const DataCache& preloadedData )
 	{
 		QList<LabelModelObject*> list;
 	
@@ -152,7 +222,7 @@ namespace glabels
 		}
 
 		/* Pass 1, extract data nodes to pre-load cache. */
-		DataCache data;
+		DataCache data = preloadedData;
 		for ( QDomNode child = root.firstChild(); !child.isNull(); child = child.nextSibling() )
 		{
 			if ( child.toElement().tagName() == "Data" )
@@ -294,37 +364,16 @@ namespace glabels
 
 		for ( QDomNode child = node.firstChild(); !child.isNull(); child = child.nextSibling() )
 		{
-			QString tagName = child.toElement().tagName();
-		
-			if ( tagName == "Object-box" )
-			{
-				list.append( parseObjectBoxNode( child.toElement() ) );
-			}
-			else if ( tagName == "Object-ellipse" )
-			{
-				list.append( parseObjectEllipseNode( child.toElement() ) );
-			}
-			else if ( tagName == "Object-line" )
-			{
-				list.append( parseObjectLineNode( child.toElement() ) );
-			}
-			else if ( tagName == "Object-text" )
-			{
-				list.append( parseObjectTextNode( child.toElement() ) );
-			}
-			else if ( tagName == "Object-image" )
-			{
-				list.append( parseObjectImageNode( child.toElement(), data ) );
-			}
-#if 0
-			else if ( tagName == "Object-barcode" )
+			if ( child.isElement() )
 			{
-				list.append( parseObjectBarcodeNode( child.toElement() ) );
+				if ( LabelModelObject* object = parseObjectNode( child.toElement(), data ) )
+				{
+					list.append( object );
+				}
 			}
-#endif
 			else if ( !child.isComment() )
 			{
-				qWarning() << "Unexpected" << node.tagName() << "child:" << tagName;
+				qWarning() << "Unexpected" << node.tagName() << "child:" << child.nodeName();
 			}
 		}
 
@@ -332,6 +381,43 @@ namespace glabels
 	}
 
 
+	LabelModelObject*
+	XmlLabelParser::parseObjectNode( const QDomElement &node, const DataCache& data )
+	{
+		QString tagName = node.tagName();
+
+		if ( tagName == "Object-box" )
+		{
+			return parseObjectBoxNode( node );
+		}
+		else if ( tagName == "Object-ellipse" )
+		{
+			return parseObjectEllipseNode( node );
+		}
+		else if ( tagName == "Object-line" )
+		{
+			return parseObjectLineNode( node );
+		}
+		else if ( tagName == "Object-text" )
+		{
+			return parseObjectTextNode( node );
+		}
+		else if ( tagName == "Object-image" )
+		{
+			return parseObjectImageNode( node, data );
+		}
+#if 0
+		else if ( tagName == "Object-barcode" )
+		{
+			return parseObjectBarcodeNode( node );
+		}
+#endif
+
+		qWarning() << "Unexpected Objects child:" << tagName;
+		return nullptr;
+	}
+
+
 	LabelModelBoxObject*
 	XmlLabelParser::parseObjectBoxNode( const QDomElement &node )
 	{
@@ -439,7 +525,15 @@ namespace glabels
 		{
 			if ( data.hasImage( filename ) )
 			{
-				object->setImage( filename, data.getImage( filename ) );
+				QByteArray imageData = data.getImageData( filename );
+				if ( !imageData.isEmpty() )
+				{
+					object->setImageData( filename, imageData );
+				}
+				else
+				{
+					object->setImage( filename, data.getImage( filename ) );
+				}
 			}
 			else if ( data.hasSvg( filename ) )
 			{
@@ -664,19 +758,201 @@ namespace glabels
 		QString mimetype = XmlUtil::getStringAttr( node, "mimetype", "image/png" );
 		QString encoding = XmlUtil::getStringAttr( node, "encoding", "base64" );
 
+		parseFileData( name, mimetype, node.text().toUtf8(), data );
+	}
+
+
+	void
+	XmlLabelParser::parseFileData( const QString&    name,
+	                               const QString&    mimetype,
+	                               const QByteArray& text,
+	                               DataCache&        data )
+	{
 		if ( mimetype == "image/png" )
 		{
-			QByteArray ba64 = node.text().toUtf8();
-			QByteArray ba = QByteArray::fromBase64( ba64 );
-			QImage image;
-			image.loadFromData( ba, "PNG" );
-
-			data.addImage( name, image );
+			// Keep encoded; image objects decode it when first drawn
+			data.addImageData( name, QByteArray::fromBase64( text ) );
 		}
 		else if ( mimetype == "image/svg+xml" )
 		{
-			data.addSvg( name, node.text().toUtf8() );
+			data.addSvg( name, text );
+		}
+	}
+
+
+	LabelModel*
+	XmlLabelParser::parseRootStream( QXmlStreamReader& reader )
+	{
+		if ( !reader.readNextStartElement() || (reader.name() != "Glabels-document") )
+		{
+			qWarning() << "Error: Not a Glabels-document file";
+			return nullptr;
+		}
+
+		QStringRef version = reader.attributes().value( "version" );
+		if ( version != "4.0" )
+		{
+			qWarning() << "Unsupported Glabels-document version" << version.toString()
+			           << ", reading it as version 4.0.";
+		}
+
+		LabelModel* label = new LabelModel();
+
+		DataCache                data;
+		QDomDocument             doc;
+		QList<LabelModelObject*> objects;
+		QMap<int,QDomElement>    imageNodes;
+
+		while ( reader.readNextStartElement() )
+		{
+			if ( reader.name() == "Template" )
+			{
+				Template* tmplate = XmlTemplateParser().parseTemplateNode( readElement( reader, doc ) );
+				if ( tmplate == nullptr )
+				{
+					qWarning() << "Unable to parse template";
+					qDeleteAll( objects );
+					delete label;
+					return nullptr;
+				}
+				label->setTmplate( tmplate );
+			}
+			else if ( reader.name() == "Objects" )
+			{
+				// Build objects as their elements close.  Data normally follows the
+				// objects, so image objects are held back until it has been read.
+				while ( reader.readNextStartElement() )
+				{
+					QDomElement node = readElement( reader, doc );
+					if ( node.tagName() == "Object-image" )
+					{
+						imageNodes.insert( objects.size(), node );
+						objects.append( nullptr );
+					}
+					else if ( LabelModelObject* object = parseObjectNode( node, data ) )
+					{
+						objects.append( object );
+					}
+				}
+			}
+			else if ( reader.name() == "Merge" )
+			{
+				parseMergeNode( readElement( reader, doc ), label );
+			}
+			else if ( reader.name() == "Data" )
+			{
+				parseDataStream( reader, data );
+			}
+			else
+			{
+				qWarning() << "Unexpected Glabels-document child:" << reader.name();
+				reader.skipCurrentElement();
+			}
+		}
+
+		if ( reader.hasError() )
+		{
+			qWarning() << "Error: Parse error at line " << reader.lineNumber()
+			           << "column " << reader.columnNumber()
+			           << ": " << reader.errorString();
+			qDeleteAll( objects );
+			delete label;
+			return nullptr;
+		}
+
+		for ( auto it = imageNodes.constBegin(); it != imageNodes.constEnd(); ++it )
+		{
+			objects[ it.key() ] = parseObjectImageNode( it.value(), data );
+		}
+
+		foreach ( LabelModelObject* object, objects )
+		{
+			label->addObject( object );
+		}
+
+		label->clearModified();
+		return label;
+	}
+
+
+	void
+	XmlLabelParser::parseDataStream( QXmlStreamReader& reader, DataCache& data )
+	{
+		while ( reader.readNextStartElement() )
+		{
+			if ( reader.name() == "File" )
+			{
+				parseFileStream( reader, data );
+			}
+			else
+			{
+				qWarning() << "Unexpected Data child:" << reader.name();
+				reader.skipCurrentElement();
+			}
+		}
+	}
+
+
+	void
+	XmlLabelParser::parseFileStream( QXmlStreamReader& reader, DataCache& data )
+	{
+		QXmlStreamAttributes attributes = reader.attributes();
+
+		QString name     = attributes.value( "name" ).toString();
+		QString mimetype = attributes.hasAttribute( "mimetype" ) ?
+			attributes.value( "mimetype" ).toString() : QString( "image/png" );
+
+		// Decoded straight into the cache; the encoded text is dropped right away
+		parseFileData( name, mimetype, reader.readElementText().toUtf8(), data );
+	}
+
+
+	///
+	/// Read current element (and its children) from stream into a stand-alone
+	/// DOM element, so that small subtrees can share the DOM parsing code.
+	///
+	QDomElement
+	XmlLabelParser::readElement( QXmlStreamReader& reader, QDomDocument& doc )
+	{
+		QDomElement element = doc.createElement( reader.name().toString() );
+		foreach ( const QXmlStreamAttribute& attribute, reader.attributes() )
+		{
+			element.setAttribute( attribute.name().toString(), attribute.value().toString() );
+		}
+
+		while ( !reader.atEnd() )
+		{
+			switch ( reader.readNext() )
+			{
+			case QXmlStreamReader::StartElement:
+				element.appendChild( readElement( reader, doc ) );
+				break;
+
+			case QXmlStreamReader::EndElement:
+				return element;
+
+			case QXmlStreamReader::Characters:
+				// Like QDomDocument::setContent(), drop whitespace-only text
+				if ( reader.isCDATA() )
+				{
+					element.appendChild( doc.createCDATASection( reader.text().toString() ) );
+				}
+				else if ( !reader.isWhitespace() )
+				{
+					element.appendChild( doc.createTextNode( reader.text().toString() ) );
+				}
+				break;
+
+			case QXmlStreamReader::Comment:
+				element.appendChild( doc.createComment( reader.text().toString() ) );
+				break;
+
+			default:
+				break;
+			}
 		}
+
+		return element;
 	}
 
 } // namespace glabels
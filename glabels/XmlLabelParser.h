@@ -24,6 +24,7 @@
 
 #include <QObject>
 #include <QDomElement>
+#include <QXmlStreamReader>
 
 
 namespace glabels
@@ -50,13 +51,16 @@ namespace glabels
 
 	public:
 		static LabelModel* readFile( const QString& fileName );
+		static LabelModel* readFileDom( const QString& fileName );
 		static LabelModel* readBuffer( const QByteArray& buffer );
 		static QList<LabelModelObject*> deserializeObjects( const QByteArray& buffer );
+		static QList<LabelModelObject*> deserializeObjects( const QByteArray& buffer, const DataCache& preloadedData );
 
 	private:
 		static void gunzip( const QByteArray& gzippedData, QByteArray& data );
 		static LabelModel* parseRootNode( const QDomElement &node );
 		static QList<LabelModelObject*> parseObjectsNode( const QDomElement &node, const DataCache& data );
+		static LabelModelObject* parseObjectNode( const QDomElement &node, const DataCache& data );
 		static LabelModelBoxObject* parseObjectBoxNode( const QDomElement &node );
 		static LabelModelEllipseObject* parseObjectEllipseNode( const QDomElement &node );
 		static LabelModelLineObject* parseObjectLineNode( const QDomElement &node );
@@ -74,6 +78,13 @@ namespace glabels
 		static void parseDataNode( const QDomElement &node, DataCache& data );
 		static void parsePixdataNode( const QDomElement &node, DataCache& data );
 		static void parseFileNode( const QDomElement &node, DataCache& data );
+		static void parseFileData( const QString& name, const QString& mimetype,
+		                           const QByteArray& text, DataCache& data );
+
+		static LabelModel* parseRootStream( QXmlStreamReader& reader );
+		static void parseDataStream( QXmlStreamReader& reader, DataCache& data );
+		static void parseFileStream( QXmlStreamReader& reader, DataCache& data );
+		static QDomElement readElement( QXmlStreamReader& reader, QDomDocument& doc );
 
 	};
 
@@ -40,6 +40,23 @@ namespace glabels
 {
 
 	bool XmlTemplateParser::readFile( const QString &fileName )
+	{
+		ParsedFile parsed;
+		if ( !parseFile( fileName, parsed ) )
+		{
+			return false;
+		}
+
+		registerTemplates( parsed );
+		return true;
+	}
+
+
+	///
+	/// Parse file without touching Db's template list, so that several
+	/// files may be parsed concurrently
+	///
+	bool XmlTemplateParser::parseFile( const QString &fileName, ParsedFile &parsed )
 	{
 		QFile file( fileName );
 
@@ -51,10 +68,10 @@ namespace glabels
 		}
 
 
-		QDomDocument doc;
-		QString      errorString;
-		int          errorLine;
-		int          errorColumn;
+		QDomDocument& doc = parsed.doc;
+		QString       errorString;
+		int           errorLine;
+		int           errorColumn;
 
 		if ( !doc.setContent( &file, false, &errorString, &errorLine, &errorColumn ) )
 		{
@@ -71,21 +88,61 @@ namespace glabels
 			return false;
 		}
 
-		parseRootNode( root );
+		parseRootNode( root, parsed );
 		return true;
 	}
 
 
-	void XmlTemplateParser::parseRootNode( const QDomElement &node )
+	///
+	/// Register parsed templates with Db, in document order.  Returns the
+	/// templates that were accepted (i.e. were not duplicates).
+	///
+	QList<Template*> XmlTemplateParser::registerTemplates( const ParsedFile &parsed )
+	{
+		QList<Template*> registered;
+
+		for ( int i = 0; i < parsed.templates.size(); i++ )
+		{
+			Template *tmplate = parsed.templates[i];
+			if ( tmplate == nullptr )
+			{
+				// Equivalent template, resolved against what is registered so far
+				tmplate = parseTemplateNode( parsed.nodes[i] );
+				if ( tmplate == nullptr )
+				{
+					qWarning() << "Warning: could not create template, Ignored.";
+					continue;
+				}
+			}
+
+			if ( Db::registerTemplate( tmplate ) )
+			{
+				registered << tmplate;
+			}
+		}
+
+		return registered;
+	}
+
+
+	void XmlTemplateParser::parseRootNode( const QDomElement &node, ParsedFile &parsed )
 	{
 		for ( QDomNode child = node.firstChild(); !child.isNull(); child = child.nextSibling() )
 		{
 			if ( child.toElement().tagName() == "Template" )
 			{
+				if ( child.toElement().hasAttribute( "equiv" ) )
+				{
+					parsed.templates << nullptr;
+					parsed.nodes << child.toElement();
+					continue;
+				}
+
 				Template *tmplate = parseTemplateNode( child.toElement() );
 				if ( tmplate != nullptr )
 				{
-					Db::registerTemplate( tmplate );
+					parsed.templates << tmplate;
+					parsed.nodes << child.toElement();
 				}
 				else
 				{
@@ -24,7 +24,9 @@
 
 #include "Template.h"
 
+#include <QDomDocument>
 #include <QDomElement>
+#include <QList>
 #include <QString>
 
 
@@ -33,14 +35,30 @@ namespace glabels
 
 	class XmlTemplateParser
 	{
+	public:
+		///
+		/// Templates parsed from one file, in document order, but not yet
+		/// registered.  Templates defined as equivalents of others can only
+		/// be resolved against Db, so they are kept as unparsed nodes (with a
+		/// null entry in templates).
+		///
+		struct ParsedFile
+		{
+			QDomDocument       doc;
+			QList<Template*>   templates;
+			QList<QDomElement> nodes;
+		};
+
 	public:
 		XmlTemplateParser() {}
 
 		bool readFile( const QString &fileName );
+		bool parseFile( const QString &fileName, ParsedFile &parsed );
+		QList<Template*> registerTemplates( const ParsedFile &parsed );
 		Template *parseTemplateNode( const QDomElement &node );
 
 	private:
-		void parseRootNode( const QDomElement &node );
+		void parseRootNode( const QDomElement &node, ParsedFile &parsed );
 		void parseMetaNode( const QDomElement &node, Template *tmplate );
 		void parseLabelRectangleNode( const QDomElement &node, Template *tmplate );
 		void parseLabelEllipseNode( const QDomElement &node, Template *tmplate );
@@ -20,7 +20,6 @@
 
 #include "XmlUtil.h"
 
-#include <QTextStream>
 #include <QCoreApplication>
 #include <QtDebug>
 
@@ -209,14 +208,22 @@ namespace glabels
 	{
 		init();
 
-		QString valueString = node.attribute( name, "" );
+		QString valueString = node.attribute( name, "" ).trimmed();
 		if ( valueString != "" )
 		{
-			double value;
-			QString unitsString;
-			QTextStream valueStream( &valueString, QIODevice::ReadOnly );
+			// Split "<number><units>" by hand; this is called for every length
+			// in every template, so avoid constructing a QTextStream each time.
+			int i = 0;
+			while ( (i < valueString.size()) &&
+			        ( valueString[i].isDigit() ||
+			          (valueString[i] == '.') || (valueString[i] == '-') || (valueString[i] == '+') ||
+			          (((valueString[i] == 'e') || (valueString[i] == 'E')) && (i > 0)) ) )
+			{
+				i++;
+			}
 
-			valueStream >> value >> unitsString;
+			double value = valueString.left( i ).toDouble();
+			QString unitsString = valueString.mid( i ).trimmed();
 
 			if ( !unitsString.isEmpty() && !Units::isIdValid( unitsString ) )
 			{
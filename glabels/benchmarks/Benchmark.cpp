@@ -0,0 +1,115 @@
+/*  Benchmark.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmark.h"
+
+#include "Db.h"
+#include "FrameRect.h"
+#include "Layout.h"
+
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QtAlgorithms>
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+
+namespace glabels
+{
+
+	void Benchmark::initApplication()
+	{
+		QCoreApplication::setOrganizationName( "glabels.org" );
+		QCoreApplication::setOrganizationDomain( "glabels.org" );
+		QCoreApplication::setApplicationName( "glabels-benchmark" );
+	}
+
+
+	qint64 Benchmark::peakMemoryKiB()
+	{
+#if defined(Q_OS_UNIX)
+		struct rusage usage;
+		if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+		{
+			return -1;
+		}
+#if defined(Q_OS_MAC)
+		return usage.ru_maxrss / 1024; // bytes
+#else
+		return usage.ru_maxrss;        // KiB
+#endif
+#else
+		return -1;
+#endif
+	}
+
+
+	void Benchmark::report( const QString& name, QList<qint64> nsecs )
+	{
+		QTextStream out( stdout );
+
+		if ( nsecs.isEmpty() )
+		{
+			out << name << ": no samples" << endl;
+			return;
+		}
+
+		qSort( nsecs );
+
+		qint64 total = 0;
+		foreach ( qint64 ns, nsecs )
+		{
+			total += ns;
+		}
+
+		out << name << ": "
+		    << "min " << nsecs.first()/1.0e6 << " ms, "
+		    << "median " << nsecs[nsecs.size()/2]/1.0e6 << " ms, "
+		    << "mean " << total/1.0e6/nsecs.size() << " ms"
+		    << " (" << nsecs.size() << " runs)" << endl;
+	}
+
+	void Benchmark::registerSyntheticTemplates( int n )
+	{
+		const Paper* paper = Db::papers().first();
+
+		for ( int i = 0; i < n; i++ )
+		{
+			// 500 widths x 100 heights, half a point apart
+			Distance w = Distance::pt( 36 + 0.5*(i % 500) );
+			Distance h = Distance::pt( 18 + 0.5*((i / 500) % 100) );
+
+			Template* tmplate = new Template( "Benchmark", QString::number( i ), "Synthetic",
+			                                  paper->id(), paper->width(), paper->height() );
+
+			Frame* frame = new FrameRect( w, h, Distance::pt( 0 ), Distance::pt( 0 ), Distance::pt( 0 ) );
+			frame->addLayout( new Layout( 1, 1, Distance::pt( 9 ), Distance::pt( 9 ), w, h ) );
+			tmplate->addFrame( frame );
+
+			if ( !Db::registerTemplate( tmplate ) )
+			{
+				delete tmplate;
+			}
+		}
+	}
+
+} // namespace glabels
@@ -0,0 +1,66 @@
+/*  Benchmark.h
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef Benchmark_h
+#define Benchmark_h
+
+
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+
+namespace glabels
+{
+
+	///
+	/// Helpers shared by the stand-alone benchmark programs
+	///
+	/// Benchmarks are only built with -DGLABELS_BENCHMARKS=ON.  They run
+	/// under their own application name, so they neither read nor clobber
+	/// the settings and caches of an installed glabels-qt.
+	///
+	namespace Benchmark
+	{
+
+		void initApplication();
+
+		///
+		/// Peak resident set size of this process in KiB, -1 if unknown
+		///
+		qint64 peakMemoryKiB();
+
+		///
+		/// Print min, median and mean of a list of timings (in ns)
+		///
+		void report( const QString& name, QList<qint64> nsecs );
+
+		///
+		/// Register n synthetic templates with Db (brand "Benchmark", parts
+		/// "0" to "n-1"), with a spread of frame sizes on the first paper size
+		///
+		void registerSyntheticTemplates( int n );
+
+	}
+
+}
+
+
+#endif // Benchmark_h
@@ -0,0 +1,170 @@
+/*  DbLookupBenchmark.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Db template lookups through its hash indexes versus the linear scans of
+// Db::templates() they replaced, with 50,000 synthetic templates registered
+// on top of the system templates:
+//
+//     QT_QPA_PLATFORM=offscreen DbLookupBenchmark [TEMPLATES] [QUERIES]
+//
+
+#include "Benchmark.h"
+
+#include "Db.h"
+#include "Settings.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+
+namespace
+{
+
+	using glabels::Db;
+	using glabels::Template;
+
+
+	//
+	// The lookups as Db did them before it had indexes
+	//
+	const Template* linearLookupFromName( const QString& name )
+	{
+		foreach ( Template* tmplate, Db::templates() )
+		{
+			if ( tmplate->name() == name )
+			{
+				return tmplate;
+			}
+		}
+		return nullptr;
+	}
+
+
+	const Template* linearLookupFromBrandPart( const QString& brand, const QString& part )
+	{
+		foreach ( Template* tmplate, Db::templates() )
+		{
+			if ( (tmplate->brand() == brand) && (tmplate->part() == part) )
+			{
+				return tmplate;
+			}
+		}
+		return nullptr;
+	}
+
+}
+
+
+int main( int argc, char **argv )
+{
+	QApplication app( argc, argv );
+	glabels::Benchmark::initApplication();
+
+	QStringList args = app.arguments();
+	int nTemplates = (args.size() > 1) ? args[1].toInt() : 50000;
+	int nQueries   = (args.size() > 2) ? args[2].toInt() : 1000;
+
+	glabels::Settings::init();
+	Db::init();
+
+	QElapsedTimer timer;
+	timer.start();
+	glabels::Benchmark::registerSyntheticTemplates( nTemplates );
+	glabels::Benchmark::report( QString( "register %1 templates" ).arg( nTemplates ),
+	                            QList<qint64>() << timer.nsecsElapsed() );
+
+	// Spread the queries evenly over the database, plus a miss every tenth
+	QList<const Template*> all;
+	foreach ( Template* tmplate, Db::templates() )
+	{
+		all << tmplate;
+	}
+	QStringList names, brands, parts;
+	for ( int i = 0; i < nQueries; i++ )
+	{
+		const Template* tmplate = all[ int( qint64(i) * all.size() / nQueries ) ];
+		bool miss = (i % 10 == 9);
+		names  << (miss ? tmplate->name() + " (missing)" : tmplate->name());
+		brands << tmplate->brand();
+		parts  << (miss ? tmplate->part() + " (missing)" : tmplate->part());
+	}
+
+	QTextStream( stdout ) << Db::templates().size() << " templates, "
+	                      << nQueries << " queries per sample" << endl;
+
+	// Misses warn once each in the indexed lookups, keep that out of the timings
+	qInstallMessageHandler( [] ( QtMsgType, const QMessageLogContext&, const QString& ) {} );
+
+	const int nSamples = 5;
+	QList<qint64> indexedName, linearName, indexedBrandPart, linearBrandPart, indexedKnown;
+	int found = 0;
+	for ( int sample = 0; sample < nSamples; sample++ )
+	{
+		timer.restart();
+		foreach ( QString name, names )
+		{
+			found += (Db::lookupTemplateFromName( name ) != nullptr);
+		}
+		indexedName << timer.nsecsElapsed();
+
+		timer.restart();
+		foreach ( QString name, names )
+		{
+			found += (linearLookupFromName( name ) != nullptr);
+		}
+		linearName << timer.nsecsElapsed();
+
+		timer.restart();
+		for ( int i = 0; i < nQueries; i++ )
+		{
+			found += (Db::lookupTemplateFromBrandPart( brands[i], parts[i] ) != nullptr);
+		}
+		indexedBrandPart << timer.nsecsElapsed();
+
+		timer.restart();
+		for ( int i = 0; i < nQueries; i++ )
+		{
+			found += (linearLookupFromBrandPart( brands[i], parts[i] ) != nullptr);
+		}
+		linearBrandPart << timer.nsecsElapsed();
+
+		timer.restart();
+		for ( int i = 0; i < nQueries; i++ )
+		{
+			found += Db::isTemplateKnown( brands[i], parts[i] );
+		}
+		indexedKnown << timer.nsecsElapsed();
+	}
+
+	qInstallMessageHandler( nullptr );
+
+	glabels::Benchmark::report( "lookupTemplateFromName, indexed", indexedName );
+	glabels::Benchmark::report( "lookupTemplateFromName, linear scan", linearName );
+	glabels::Benchmark::report( "lookupTemplateFromBrandPart, indexed", indexedBrandPart );
+	glabels::Benchmark::report( "lookupTemplateFromBrandPart, linear scan", linearBrandPart );
+	glabels::Benchmark::report( "isTemplateKnown, indexed", indexedKnown );
+
+	// Keeps the lookups from being optimized away
+	QTextStream( stdout ) << found << " hits" << endl;
+
+	return 0;
+}
@@ -0,0 +1,90 @@
+/*  LabelLoadBenchmark.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Load time and peak memory of XmlLabelParser::readFile() (streaming) versus
+// XmlLabelParser::readFileDom() (whole file, inflated, then a DOM tree).
+//
+// Peak memory is per process, so run each reader in a process of its own:
+//
+//     QT_QPA_PLATFORM=offscreen LabelLoadBenchmark stream big.glabels 10
+//     QT_QPA_PLATFORM=offscreen LabelLoadBenchmark dom    big.glabels 10
+//
+
+#include "Benchmark.h"
+
+#include "Db.h"
+#include "LabelModel.h"
+#include "Settings.h"
+#include "XmlLabelParser.h"
+
+#include "Merge/Factory.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+
+int main( int argc, char **argv )
+{
+	QApplication app( argc, argv );
+	glabels::Benchmark::initApplication();
+
+	QStringList args = app.arguments();
+	if ( (args.size() < 3) || ((args[1] != "dom") && (args[1] != "stream")) )
+	{
+		QTextStream( stderr ) << "Usage: " << args[0] << " dom|stream FILE [RUNS]" << endl;
+		return 1;
+	}
+	bool    useDom   = (args[1] == "dom");
+	QString fileName = args[2];
+	int     nRuns    = (args.size() > 3) ? args[3].toInt() : 5;
+
+	glabels::Settings::init();
+	glabels::Db::init();
+	glabels::merge::Factory::init();
+
+	qint64 baselineKiB = glabels::Benchmark::peakMemoryKiB();
+
+	QList<qint64> nsecs;
+	for ( int i = 0; i < nRuns; i++ )
+	{
+		QElapsedTimer timer;
+		timer.start();
+
+		glabels::LabelModel* label = useDom ? glabels::XmlLabelParser::readFileDom( fileName )
+		                                    : glabels::XmlLabelParser::readFile( fileName );
+		nsecs << timer.nsecsElapsed();
+
+		if ( label == nullptr )
+		{
+			QTextStream( stderr ) << "Cannot read " << fileName << endl;
+			return 1;
+		}
+		delete label;
+	}
+
+	glabels::Benchmark::report( useDom ? "readFileDom" : "readFile", nsecs );
+
+	QTextStream( stdout ) << "peak memory: " << glabels::Benchmark::peakMemoryKiB() << " KiB"
+	                      << " (" << baselineKiB << " KiB before loading)" << endl;
+
+	return 0;
+}
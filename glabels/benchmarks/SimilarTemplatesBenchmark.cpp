@@ -0,0 +1,145 @@
+/*  SimilarTemplatesBenchmark.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Db::getNameListOfSimilarTemplates(), which only looks at templates in
+// neighbouring geometry buckets, versus the scan of every template it
+// replaced, with 50,000 synthetic templates registered on top of the system
+// templates.  Both must find the same templates; any query where they do not
+// is counted and reported.
+//
+//     QT_QPA_PLATFORM=offscreen SimilarTemplatesBenchmark [TEMPLATES] [QUERIES]
+//
+
+#include "Benchmark.h"
+
+#include "Db.h"
+#include "Settings.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+
+namespace
+{
+
+	using glabels::Db;
+	using glabels::Template;
+
+
+	//
+	// The query as Db did it before it bucketed templates by geometry
+	//
+	QStringList linearSimilarTemplates( const QString& name )
+	{
+		QStringList list;
+
+		const Template* tmplate1 = Db::lookupTemplateFromName( name );
+		foreach ( const Template* tmplate2, Db::templates() )
+		{
+			if ( tmplate1->name() != tmplate2->name() )
+			{
+				if ( tmplate1->isSimilarTo( tmplate2 ) )
+				{
+					list << tmplate2->name();
+				}
+			}
+		}
+
+		return list;
+	}
+
+}
+
+
+int main( int argc, char **argv )
+{
+	QApplication app( argc, argv );
+	glabels::Benchmark::initApplication();
+
+	QStringList args = app.arguments();
+	int nTemplates = (args.size() > 1) ? args[1].toInt() : 50000;
+	int nQueries   = (args.size() > 2) ? args[2].toInt() : 200;
+
+	glabels::Settings::init();
+	Db::init();
+
+	glabels::Benchmark::registerSyntheticTemplates( nTemplates );
+
+	// Spread the queries evenly over the database
+	QStringList names;
+	for ( int i = 0; i < nQueries; i++ )
+	{
+		const Template* tmplate = Db::templates()[ int( qint64(i) * Db::templates().size() / nQueries ) ];
+		if ( !tmplate->frames().isEmpty() )
+		{
+			names << tmplate->name();
+		}
+	}
+
+	QTextStream( stdout ) << Db::templates().size() << " templates, "
+	                      << names.size() << " queries per sample" << endl;
+
+	QList<QStringList> bucketedResults, linearResults;
+
+	QElapsedTimer timer;
+	const int nSamples = 3;
+	QList<qint64> bucketed, linear;
+	for ( int sample = 0; sample < nSamples; sample++ )
+	{
+		bucketedResults.clear();
+		timer.start();
+		foreach ( QString name, names )
+		{
+			bucketedResults << Db::getNameListOfSimilarTemplates( name );
+		}
+		bucketed << timer.nsecsElapsed();
+
+		linearResults.clear();
+		timer.restart();
+		foreach ( QString name, names )
+		{
+			linearResults << linearSimilarTemplates( name );
+		}
+		linear << timer.nsecsElapsed();
+	}
+
+	glabels::Benchmark::report( "getNameListOfSimilarTemplates, bucketed", bucketed );
+	glabels::Benchmark::report( "getNameListOfSimilarTemplates, linear scan", linear );
+
+	// Synthetic templates are not sorted into Db::templates(), so compare as sets
+	int mismatches = 0;
+	int similar    = 0;
+	for ( int i = 0; i < names.size(); i++ )
+	{
+		similar += linearResults[i].size();
+		if ( bucketedResults[i].toSet() != linearResults[i].toSet() )
+		{
+			QTextStream( stdout ) << "Mismatch for " << names[i] << endl;
+			mismatches++;
+		}
+	}
+
+	QTextStream( stdout ) << similar << " similar templates found, "
+	                      << mismatches << " mismatched queries" << endl;
+
+	return (mismatches == 0) ? 0 : 1;
+}
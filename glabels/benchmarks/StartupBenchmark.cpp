@@ -0,0 +1,138 @@
+/*  StartupBenchmark.cpp
+ *
+ *  Copyright (C) 2016  Jim Evins <evins@snaught.com>
+ *
+ *  This file is part of gLabels-qt.
+ *
+ *  gLabels-qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gLabels-qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gLabels-qt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Startup time up to a shown main window, with and without the binary
+// template cache (DbCache).  Db is a singleton and can be initialized only
+// once per process, so every sample is taken by running this program again
+// as a child process:
+//
+//     QT_QPA_PLATFORM=offscreen StartupBenchmark [RUNS]
+//
+// A "cold" child first removes the benchmark's cache directory, so Db parses
+// every template file and writes the cache; a "warm" child reads it back.
+// Time spent constructing QApplication is not included.
+//
+
+#include "Benchmark.h"
+
+#include "Db.h"
+#include "FileUtil.h"
+#include "MainWindow.h"
+#include "Settings.h"
+
+#include "Merge/Factory.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QTextStream>
+
+
+namespace
+{
+
+	//
+	// One startup, prints nanoseconds to Db ready and to window shown
+	//
+	int runChild( QApplication& app, bool cold )
+	{
+		if ( cold )
+		{
+			glabels::FileUtil::cacheDir().removeRecursively();
+		}
+
+		QElapsedTimer timer;
+		timer.start();
+
+		glabels::Settings::init();
+		glabels::Db::init();
+		qint64 dbNs = timer.nsecsElapsed();
+
+		glabels::merge::Factory::init();
+
+		glabels::MainWindow mainWindow;
+		mainWindow.show();
+		app.processEvents();
+		qint64 windowNs = timer.nsecsElapsed();
+
+		QTextStream( stdout ) << dbNs << " " << windowNs << endl;
+		return 0;
+	}
+
+
+	bool runChildProcess( const QString& program, const QString& mode,
+	                      QList<qint64>& dbNs, QList<qint64>& windowNs )
+	{
+		QProcess child;
+		child.setProcessChannelMode( QProcess::ForwardedErrorChannel );
+		child.start( program, QStringList() << "--child" << mode );
+
+		if ( !child.waitForFinished( -1 ) || (child.exitCode() != 0) )
+		{
+			QTextStream( stderr ) << "Startup run failed: " << child.errorString() << endl;
+			return false;
+		}
+
+		QStringList fields = QString( child.readAllStandardOutput() ).split( ' ' );
+		if ( fields.size() != 2 )
+		{
+			return false;
+		}
+
+		dbNs     << fields[0].toLongLong();
+		windowNs << fields[1].trimmed().toLongLong();
+		return true;
+	}
+
+}
+
+
+int main( int argc, char **argv )
+{
+	QApplication app( argc, argv );
+	glabels::Benchmark::initApplication();
+
+	QStringList args = app.arguments();
+	if ( (args.size() == 3) && (args[1] == "--child") )
+	{
+		return runChild( app, args[2] == "cold" );
+	}
+
+	int nRuns = (args.size() > 1) ? args[1].toInt() : 5;
+
+	foreach ( QString mode, QStringList() << "cold" << "warm" )
+	{
+		QList<qint64> dbNs, windowNs;
+		for ( int i = 0; i < nRuns; i++ )
+		{
+			if ( !runChildProcess( app.applicationFilePath(), mode, dbNs, windowNs ) )
+			{
+				return 1;
+			}
+		}
+
+		glabels::Benchmark::report( QString( "Db::init (%1 cache)" ).arg( mode ), dbNs );
+		glabels::Benchmark::report( QString( "startup to window (%1 cache)" ).arg( mode ), windowNs );
+	}
+
+	return 0;
+}
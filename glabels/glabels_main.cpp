@@ -25,6 +25,7 @@
 #include <QtDebug>
 
 #include "FileUtil.h"
+#include "File.h"
 #include "Db.h"
 #include "MainWindow.h"
 #include "Settings.h"
@@ -76,5 +77,7 @@ int main( int argc, char **argv )
 	glabels::MainWindow mainWindow;
 	mainWindow.show();
 
+	glabels::File::recover( &mainWindow );
+
 	return app.exec();
 }